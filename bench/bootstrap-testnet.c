@@ -0,0 +1,189 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+#include "../src/fs-sync.h"
+
+// Measures the throughput of a bootstrap against a local DHT testnet and a
+// peer seeding a synthetic platform of the given size, in bytes, so that no
+// outside services are involved. Run from the repository root after installing
+// the JavaScript dependencies, as the testnet is started using node.
+//
+//   bootstrap-testnet [size]
+
+#define SIZE (64 * 1024 * 1024)
+
+static uv_loop_t *loop;
+
+static uv_process_t process;
+static uv_pipe_t input_pipe;
+static uv_pipe_t output_pipe;
+
+static char output[2048];
+static size_t output_len;
+
+static appling_bootstrap_t req;
+
+static appling_path_t dir;
+
+static uint64_t size;
+
+static int
+hex(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+static void
+on_bootstrap(appling_bootstrap_t *req, int status) {
+  int err;
+
+  assert(status == 0);
+
+  double elapsed = (req->timing.end - req->timing.start) / 1e9;
+
+  printf("size=%llu\n", (unsigned long long) size);
+  printf("elapsed=%.3fs\n", elapsed);
+  printf("fetched=%llu reused=%llu\n", (unsigned long long) req->fetched, (unsigned long long) req->reused);
+  printf("throughput=%.2fMiB/s\n", req->fetched / elapsed / (1024 * 1024));
+  printf("peak_rss=%.2fMiB\n", req->peak_rss / (1024.0 * 1024));
+
+  char timing[256];
+  size_t timing_len = sizeof(timing);
+
+  err = appling_bootstrap_format_timing(&req->timing, timing, &timing_len);
+  assert(err == 0);
+
+  printf("%s\n", timing);
+
+  uv_close((uv_handle_t *) &input_pipe, NULL); // Stops the testnet
+}
+
+static void
+on_alloc(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
+  *buf = uv_buf_init(output + output_len, sizeof(output) - output_len - 1);
+}
+
+static void
+on_read(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf) {
+  int err;
+
+  if (nread < 0) {
+    uv_close((uv_handle_t *) stream, NULL);
+    return;
+  }
+
+  output_len += nread;
+  output[output_len] = '\0';
+
+  char *end = strchr(output, '\n');
+
+  if (end == NULL) return;
+
+  *end = '\0';
+
+  uv_read_stop(stream);
+
+  char *nodes = strchr(output, ' ');
+  assert(nodes && nodes - output == APPLING_KEY_LEN * 2);
+
+  *nodes++ = '\0';
+
+  appling_key_t key;
+
+  for (size_t i = 0; i < APPLING_KEY_LEN; i++) {
+    key[i] = (uint8_t) (hex(output[i * 2]) << 4 | hex(output[i * 2 + 1]));
+  }
+
+  appling_bootstrap_options_t options = {
+    .version = 0,
+    .nodes = nodes,
+  };
+
+  err = appling_bootstrap(loop, &req, key, dir, &options, on_bootstrap);
+  assert(err == 0);
+}
+
+static void
+on_process_exit(uv_process_t *handle, int64_t exit_status, int term_signal) {
+  assert(exit_status == 0);
+
+  uv_close((uv_handle_t *) handle, NULL);
+}
+
+int
+main(int argc, char *argv[]) {
+  int err;
+
+  size = argc > 1 ? strtoull(argv[1], NULL, 10) : SIZE;
+
+  loop = uv_default_loop();
+
+  appling_path_t tmp;
+  size_t path_len = sizeof(appling_path_t);
+
+  err = uv_os_tmpdir(tmp, &path_len);
+  assert(err == 0);
+
+  appling_path_t pattern;
+  path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {tmp, "appling-bench-XXXXXX", NULL},
+    pattern,
+    &path_len,
+    path_behavior_system
+  );
+
+  uv_fs_t fs;
+  err = uv_fs_mkdtemp(loop, &fs, pattern, NULL);
+  assert(err == 0);
+
+  strcpy(dir, fs.path);
+
+  uv_fs_req_cleanup(&fs);
+
+  char length[32];
+  snprintf(length, sizeof(length), "%llu", (unsigned long long) size);
+
+  char *args[] = {"node", "bench/testnet.js", length, NULL};
+
+  err = uv_pipe_init(loop, &input_pipe, 0);
+  assert(err == 0);
+
+  err = uv_pipe_init(loop, &output_pipe, 0);
+  assert(err == 0);
+
+  uv_stdio_container_t stdio[] = {
+    {.flags = UV_CREATE_PIPE | UV_READABLE_PIPE, .data.stream = (uv_stream_t *) &input_pipe},
+    {.flags = UV_CREATE_PIPE | UV_WRITABLE_PIPE, .data.stream = (uv_stream_t *) &output_pipe},
+    {.flags = UV_INHERIT_FD, .data.fd = 2},
+  };
+
+  uv_process_options_t options = {
+    .exit_cb = on_process_exit,
+    .file = "node",
+    .args = args,
+    .stdio_count = 3,
+    .stdio = stdio,
+  };
+
+  err = uv_spawn(loop, &process, &options);
+  assert(err == 0);
+
+  err = uv_read_start((uv_stream_t *) &output_pipe, on_alloc, on_read);
+  assert(err == 0);
+
+  err = uv_run(loop, UV_RUN_DEFAULT);
+  assert(err == 0);
+
+  err = appling_fs__rm(loop, dir);
+  assert(err == 0);
+
+  return 0;
+}
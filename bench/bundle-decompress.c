@@ -0,0 +1,95 @@
+#include <assert.h>
+#include <path.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+#include "../src/bootstrap.bundle.h"
+#include "../src/lz4.h"
+
+// Measures the size of the compressed bootstrap bundle, the size of the
+// bootstrap module embedding it, and the cost of decompressing it. Requires a
+// build with APPLING_COMPRESS_BUNDLE enabled; the module size of a build
+// without it is reported by warm-launch for comparison.
+//
+//   bundle-decompress [runs]
+
+#define RUNS 100
+
+static uint64_t
+size_of(const char *path) {
+  uv_fs_t req;
+  int err = uv_fs_stat(NULL, &req, path, NULL);
+
+  uint64_t size = err == 0 ? req.statbuf.st_size : 0;
+
+  uv_fs_req_cleanup(&req);
+
+  return size;
+}
+
+int
+main(int argc, char **argv) {
+  int err;
+
+  int runs = argc > 1 ? atoi(argv[1]) : RUNS;
+
+  uint8_t *bundle = malloc(bootstrap_bundle_len);
+  assert(bundle);
+
+  uint64_t total = 0, min = UINT64_MAX;
+
+  for (int i = 0; i < runs; i++) {
+    size_t len = bootstrap_bundle_len;
+
+    uint64_t start = uv_hrtime();
+
+    err = appling_lz4__decompress(bootstrap_bundle_compressed, bootstrap_bundle_compressed_len, bundle, &len);
+    assert(err == 0 && len == bootstrap_bundle_len);
+
+    uint64_t elapsed = uv_hrtime() - start;
+
+    total += elapsed;
+
+    if (elapsed < min) min = elapsed;
+  }
+
+  free(bundle);
+
+  appling_path_t exe;
+  size_t exe_len = sizeof(appling_path_t);
+
+  err = uv_exepath(exe, &exe_len);
+  assert(err == 0);
+
+  appling_path_t base;
+  strcpy(base, exe);
+
+  while (exe_len > 0 && base[exe_len - 1] != '/' && base[exe_len - 1] != '\\') exe_len--;
+
+  base[exe_len] = '\0';
+
+  appling_path_t module;
+  size_t module_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {base, appling_bootstrap_module, NULL},
+    module,
+    &module_len,
+    path_behavior_system
+  );
+
+  printf("runs=%d\n", runs);
+  printf("binary_size=%llu\n", (unsigned long long) size_of(exe));
+  printf("module_size=%llu\n", (unsigned long long) size_of(module));
+  printf("uncompressed_size=%u\n", bootstrap_bundle_len);
+  printf("compressed_size=%u\n", bootstrap_bundle_compressed_len);
+  printf("ratio=%.3f\n", (double) bootstrap_bundle_compressed_len / bootstrap_bundle_len);
+  printf("decompress_min=%.3fms\n", min / 1e6);
+  printf("decompress_mean=%.3fms\n", total / 1e6 / runs);
+
+  return 0;
+}
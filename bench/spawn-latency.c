@@ -0,0 +1,121 @@
+#include <assert.h>
+#include <errno.h>
+#include <spawn.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <uv.h>
+
+// Measures the latency of starting a child process and waiting for it to exit
+// as the resident set of the parent grows, comparing fork() followed by execv(),
+// as the platform entry points used to start the runtime, with posix_spawn().
+// The child is this executable, which exits immediately when passed `child`.
+//
+//   spawn-latency [max resident MiB] [runs]
+
+#define MAX_RESIDENT 2048
+#define RUNS 50
+
+extern char **environ;
+
+static uint64_t
+run_fork(const char *file, char *const argv[]) {
+  uint64_t start = uv_hrtime();
+
+  pid_t pid = fork();
+  assert(pid >= 0);
+
+  if (pid == 0) {
+    execv(file, argv);
+
+    _exit(1);
+  }
+
+  int status;
+  int err;
+
+  do err = waitpid(pid, &status, 0);
+  while (err < 0 && errno == EINTR);
+
+  assert(err == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  return uv_hrtime() - start;
+}
+
+static uint64_t
+run_spawn(const char *file, char *const argv[]) {
+  uint64_t start = uv_hrtime();
+
+  pid_t pid;
+  int err = posix_spawn(&pid, file, NULL, NULL, argv, environ);
+  assert(err == 0);
+
+  int status;
+
+  do err = waitpid(pid, &status, 0);
+  while (err < 0 && errno == EINTR);
+
+  assert(err == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  return uv_hrtime() - start;
+}
+
+int
+main(int argc, char **argv) {
+  int err;
+
+  if (argc > 1 && strcmp(argv[1], "child") == 0) return 0;
+
+  size_t max_resident = argc > 1 ? strtoul(argv[1], NULL, 10) : MAX_RESIDENT;
+  size_t runs = argc > 2 ? strtoul(argv[2], NULL, 10) : RUNS;
+
+  char file[4096];
+  size_t file_len = sizeof(file);
+
+  err = uv_exepath(file, &file_len);
+  assert(err == 0);
+
+  char *child_argv[] = {file, "child", NULL};
+
+  long page_size = sysconf(_SC_PAGESIZE);
+
+  printf("%10s %14s %14s\n", "rss_mib", "fork_exec_us", "posix_spawn_us");
+
+  char *ballast = NULL;
+  size_t ballast_len = 0;
+
+  for (size_t resident = 0; resident <= max_resident; resident = resident ? resident * 2 : 64) {
+    size_t len = resident * 1024 * 1024;
+
+    if (len > ballast_len) {
+      ballast = realloc(ballast, len);
+      assert(ballast);
+
+      // Touch every page so that it is resident and mapped.
+      for (size_t i = ballast_len; i < len; i += page_size) ballast[i] = 1;
+
+      ballast_len = len;
+    }
+
+    uint64_t fork_total = 0, spawn_total = 0;
+
+    for (size_t i = 0; i < runs; i++) {
+      fork_total += run_fork(file, child_argv);
+      spawn_total += run_spawn(file, child_argv);
+    }
+
+    printf(
+      "%10zu %14.1f %14.1f\n",
+      resident,
+      fork_total / (double) runs / 1e3,
+      spawn_total / (double) runs / 1e3
+    );
+  }
+
+  free(ballast);
+
+  return 0;
+}
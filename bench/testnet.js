@@ -0,0 +1,107 @@
+// Starts a local DHT testnet and a peer seeding the given number of synthetic
+// platforms of the given size, in bytes, and prints the keys of the platforms
+// followed by the bootstrap nodes of the testnet on a single line. Runs until
+// stdin is closed, at which point the number of connections made to the peer
+// and the number of bytes it uploaded are printed on a second line.
+//
+//   node bench/testnet.js [size] [count]
+
+const crypto = require('crypto')
+const fs = require('fs')
+const os = require('os')
+const path = require('path')
+const createTestnet = require('hyperdht/testnet')
+const Corestore = require('corestore')
+const Hyperdrive = require('hyperdrive')
+const Hyperswarm = require('hyperswarm')
+
+const CHUNK = 4 * 1024 * 1024
+
+async function main() {
+  const size = Number(process.argv[2] || 64 * 1024 * 1024)
+  const count = Number(process.argv[3] || 1)
+
+  const testnet = await createTestnet(3, { host: '127.0.0.1' })
+
+  const dir = await fs.promises.mkdtemp(
+    path.join(os.tmpdir(), 'appling-testnet-')
+  )
+
+  const store = new Corestore(dir)
+
+  const host = `${process.platform}-${process.arch}`
+
+  let connections = 0
+  let uploaded = 0
+
+  const onupload = (index, byteLength) => {
+    uploaded += byteLength
+  }
+
+  const drives = []
+
+  for (let i = 0; i < count; i++) {
+    const drive = new Hyperdrive(store.namespace(`platform-${i}`))
+    await drive.ready()
+
+    await drive.put(
+      '/package.json',
+      Buffer.from(JSON.stringify({ name: 'pear', version: '0.0.0' }))
+    )
+
+    for (let j = 0, offset = 0; offset < size; j++, offset += CHUNK) {
+      await drive.put(
+        `/by-arch/${host}/lib/chunk-${j}`,
+        crypto.randomBytes(Math.min(CHUNK, size - offset))
+      )
+    }
+
+    const blobs = await drive.getBlobs()
+
+    drive.core.on('upload', onupload)
+    blobs.core.on('upload', onupload)
+
+    drives.push(drive)
+  }
+
+  const swarm = new Hyperswarm({ bootstrap: testnet.bootstrap })
+
+  swarm.on('connection', (connection) => {
+    connections++
+
+    store.replicate(connection)
+  })
+
+  for (const drive of drives) {
+    swarm.join(drive.discoveryKey, { server: true, client: false })
+  }
+
+  await swarm.flush()
+
+  const keys = drives.map((drive) => drive.key.toString('hex')).join(' ')
+
+  const nodes = testnet.bootstrap
+    .map((node) => `${node.host}:${node.port}`)
+    .join(',')
+
+  process.stdout.write(`${keys} ${nodes}\n`)
+
+  process.stdin.on('end', async () => {
+    process.stdout.write(`connections=${connections} uploaded=${uploaded}\n`)
+
+    await swarm.destroy()
+    await store.close()
+    await testnet.destroy()
+    await fs.promises.rm(dir, { recursive: true, force: true })
+
+    process.exit(0)
+  })
+
+  process.stdin.resume()
+}
+
+main().catch((err) => {
+  console.error(err)
+
+  process.exit(1)
+})
@@ -0,0 +1,204 @@
+#include <assert.h>
+#include <path.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+// Measures the warm launch path of an appling: the time from exec until the
+// platform has been resolved and would be launched, the page faults incurred
+// along the way, and the size of the binary. Run from the repository root
+// after building the test fixtures, optionally passing the number of runs.
+// Only the public API is used, so the same file can be built against a tree
+// from before the bootstrap runtime was split into its own module to compare
+// the two.
+//
+//   warm-launch [runs] [dir]
+
+#define RUNS 50
+
+static uv_loop_t *loop;
+
+static uv_process_t process;
+static uv_pipe_t output_pipe;
+
+static char output[256];
+static size_t output_len;
+
+static uint64_t elapsed;
+
+static void
+on_resolve(appling_resolve_t *req, int status) {
+  assert(status == 0);
+
+  // This is where an appling would call appling_launch().
+
+  uv_rusage_t usage;
+  int err = uv_getrusage(&usage);
+  assert(err == 0);
+
+  printf("%llu %llu %llu\n", (unsigned long long) usage.ru_minflt, (unsigned long long) usage.ru_majflt, (unsigned long long) usage.ru_maxrss);
+}
+
+static int
+child(const char *dir) {
+  int err;
+
+  appling_resolve_t req;
+  appling_platform_t platform = {0};
+
+  err = appling_resolve(uv_default_loop(), &req, dir, &platform, on_resolve);
+  assert(err == 0);
+
+  err = uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+  assert(err == 0);
+
+  return 0;
+}
+
+static void
+on_alloc(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
+  *buf = uv_buf_init(output + output_len, sizeof(output) - output_len - 1);
+}
+
+static void
+on_read(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf) {
+  if (nread < 0) uv_close((uv_handle_t *) stream, NULL);
+  else output_len += nread;
+}
+
+static void
+on_process_exit(uv_process_t *handle, int64_t exit_status, int term_signal) {
+  assert(exit_status == 0);
+
+  elapsed = uv_hrtime() - elapsed;
+
+  uv_close((uv_handle_t *) handle, NULL);
+}
+
+static int
+compare(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+
+  return x < y ? -1 : x > y;
+}
+
+static uint64_t
+size_of(const char *path) {
+  uv_fs_t req;
+  int err = uv_fs_stat(NULL, &req, path, NULL);
+
+  uint64_t size = err == 0 ? req.statbuf.st_size : 0;
+
+  uv_fs_req_cleanup(&req);
+
+  return size;
+}
+
+int
+main(int argc, char **argv) {
+  int err;
+
+  if (argc == 3 && strcmp(argv[1], "--child") == 0) return child(argv[2]);
+
+  int runs = argc > 1 ? atoi(argv[1]) : RUNS;
+
+  char *dir = argc > 2 ? argv[2] : "test/fixtures/resolve/current";
+
+  loop = uv_default_loop();
+
+  appling_path_t exe;
+  size_t exe_len = sizeof(appling_path_t);
+
+  err = uv_exepath(exe, &exe_len);
+  assert(err == 0);
+
+  uint64_t *times = calloc(runs, sizeof(uint64_t));
+
+  uint64_t minflt = 0, majflt = 0, maxrss = 0;
+
+  for (int i = 0; i < runs; i++) {
+    char *args[] = {exe, "--child", dir, NULL};
+
+    err = uv_pipe_init(loop, &output_pipe, 0);
+    assert(err == 0);
+
+    uv_stdio_container_t stdio[] = {
+      {.flags = UV_IGNORE},
+      {.flags = UV_CREATE_PIPE | UV_WRITABLE_PIPE, .data.stream = (uv_stream_t *) &output_pipe},
+      {.flags = UV_INHERIT_FD, .data.fd = 2},
+    };
+
+    uv_process_options_t options = {
+      .exit_cb = on_process_exit,
+      .file = exe,
+      .args = args,
+      .stdio_count = 3,
+      .stdio = stdio,
+    };
+
+    output_len = 0;
+
+    elapsed = uv_hrtime();
+
+    err = uv_spawn(loop, &process, &options);
+    assert(err == 0);
+
+    err = uv_read_start((uv_stream_t *) &output_pipe, on_alloc, on_read);
+    assert(err == 0);
+
+    err = uv_run(loop, UV_RUN_DEFAULT);
+    assert(err == 0);
+
+    output[output_len] = '\0';
+
+    unsigned long long a, b, c;
+    err = sscanf(output, "%llu %llu %llu", &a, &b, &c);
+    assert(err == 3);
+
+    times[i] = elapsed;
+
+    minflt += a;
+    majflt += b;
+    maxrss += c;
+  }
+
+  qsort(times, runs, sizeof(uint64_t), compare);
+
+  printf("runs=%d\n", runs);
+  printf("binary_size=%llu\n", (unsigned long long) size_of(exe));
+
+#if defined(APPLING_BOOTSTRAP_MODULE)
+  appling_path_t base;
+  strcpy(base, exe);
+
+  while (exe_len > 0 && base[exe_len - 1] != '/' && base[exe_len - 1] != '\\') exe_len--;
+
+  base[exe_len] = '\0';
+
+  appling_path_t module;
+  size_t module_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {base, appling_bootstrap_module, NULL},
+    module,
+    &module_len,
+    path_behavior_system
+  );
+
+  printf("module_size=%llu\n", (unsigned long long) size_of(module));
+#endif
+
+  printf("exec_to_launch_min=%.3fms\n", times[0] / 1e6);
+  printf("exec_to_launch_median=%.3fms\n", times[runs / 2] / 1e6);
+  printf("minor_faults=%llu\n", (unsigned long long) (minflt / runs));
+  printf("major_faults=%llu\n", (unsigned long long) (majflt / runs));
+  printf("max_rss=%lluKB\n", (unsigned long long) (maxrss / runs));
+
+  free(times);
+
+  return 0;
+}
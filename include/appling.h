@@ -6,7 +6,6 @@ extern "C" {
 #endif
 
 #include <fs.h>
-#include <js.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -19,6 +18,7 @@ extern "C" {
 #define APPLING_KEY_LEN       32
 #define APPLING_ID_MAX        64
 #define APPLING_LINK_DATA_MAX 4096
+#define APPLING_NODES_MAX     1024
 
 typedef uint8_t appling_key_t[APPLING_KEY_LEN];
 typedef char appling_id_t[APPLING_ID_MAX + 1 /* NULL */];
@@ -31,9 +31,20 @@ typedef struct appling_lock_s appling_lock_t;
 typedef struct appling_resolve_s appling_resolve_t;
 typedef struct appling_paths_s appling_paths_t;
 typedef struct appling_bootstrap_s appling_bootstrap_t;
+typedef struct appling_bootstrap_options_s appling_bootstrap_options_t;
+typedef struct appling_bootstrap_timing_s appling_bootstrap_timing_t;
+typedef struct appling_updater_s appling_updater_t;
+typedef struct appling_updater_options_s appling_updater_options_t;
+typedef struct appling_gc_s appling_gc_t;
+typedef struct appling_gc_options_s appling_gc_options_t;
 typedef struct appling_ready_info_s appling_ready_info_t;
 typedef struct appling_preflight_info_s appling_preflight_info_t;
 typedef struct appling_launch_info_s appling_launch_info_t;
+typedef struct appling_session_s appling_session_t;
+typedef struct appling_process_s appling_process_t;
+typedef struct appling_run_s appling_run_t;
+typedef struct appling_batch_s appling_batch_t;
+typedef struct appling_batch_options_s appling_batch_options_t;
 
 typedef void (*appling_lock_cb)(appling_lock_t *req, int status);
 typedef void (*appling_unlock_cb)(appling_lock_t *req, int status);
@@ -41,9 +52,15 @@ typedef void (*appling_resolve_cb)(appling_resolve_t *req, int status);
 typedef void (*appling_paths_cb)(appling_paths_t *req, int status, const appling_app_t *apps, size_t len);
 typedef void (*appling_bootstrap_cb)(appling_bootstrap_t *req, int status);
 typedef void (*appling_progress_cb)(uint64_t downloaded, uint64_t total);
+typedef void (*appling_updater_cb)(appling_updater_t *updater, int status, uint64_t length, uint64_t fork);
+typedef void (*appling_updater_close_cb)(appling_updater_t *updater);
+typedef void (*appling_gc_cb)(appling_gc_t *req, int status);
 typedef int (*appling_ready_cb)(const appling_ready_info_t *info);
 typedef int (*appling_preflight_cb)(const appling_preflight_info_t *info);
 typedef int (*appling_launch_cb)(const appling_launch_info_t *info);
+typedef void (*appling_process_cb)(appling_process_t *process, int status, int64_t exit_status, int term_signal);
+typedef void (*appling_run_cb)(appling_run_t *req, int status, int64_t exit_status, uint64_t duration);
+typedef void (*appling_batch_cb)(appling_batch_t *req, int status);
 
 struct appling_platform_s {
   appling_path_t path;
@@ -93,20 +110,46 @@ struct appling_resolve_s {
   fs_read_t read;
   fs_close_t close;
 
+  uv_async_t resume;
+
   appling_path_t path;
+  appling_path_t system;
 
   uv_file file;
   uv_buf_t buf;
 
   size_t candidate;
 
+  bool searching_system;
+
   appling_platform_t *platform;
+  appling_platform_t requested;
+  appling_platform_t user;
+
+  int user_status;
 
   int status;
 
   void *data;
 };
 
+/**
+ * Monotonic timestamps, in nanoseconds as returned by `uv_hrtime()`, of the
+ * phases of a bootstrap, or 0 for phases that were never reached.
+ */
+struct appling_bootstrap_timing_s {
+  uint64_t start;    // appling_bootstrap() was called
+  uint64_t thread;   // The bootstrap thread, or child process, started
+  uint64_t lock;     // The bootstrap lock of the platform directory was acquired
+  uint64_t setup;    // The runtime was set up
+  uint64_t load;     // The bootstrap bundle was loaded
+  uint64_t connect;  // The first peer was connected
+  uint64_t transfer; // The platform was transferred
+  uint64_t run;      // The runtime finished running
+  uint64_t teardown; // The runtime was torn down
+  uint64_t end;      // The bootstrap finished
+};
+
 struct appling_bootstrap_s {
   uv_loop_t *loop;
 
@@ -114,12 +157,77 @@ struct appling_bootstrap_s {
 
   appling_key_t key;
   appling_path_t dir;
+  appling_path_t seed;
   appling_link_t link;
 
-  js_platform_t *js;
+  uint64_t length;
+
+  appling_path_t module;
+  appling_path_t storage;
+
+  char nodes[APPLING_NODES_MAX + 1 /* NULL */];
+
+  appling_progress_cb progress;
+
+  size_t memory_limit;
+  size_t stack_size;
+
+  bool shared;
+  bool dedupe;
+
+  /**
+   * The peak resident set size, in bytes, of the whole process that ran the
+   * bootstrap, as observed when the bootstrap finished. This is not the peak of
+   * the bootstrap alone, as it includes all memory used by the process before
+   * and during the bootstrap, except when bootstrapping in a child process of
+   * its own. Only valid once the bootstrap callback is invoked.
+   */
+  size_t peak_rss;
+
+  /**
+   * The timestamps of each phase of the bootstrap. Only valid once the
+   * bootstrap callback is invoked.
+   */
+  appling_bootstrap_timing_t timing;
+
+  /**
+   * The number of bytes of the platform that were already in storage, such as
+   * from an earlier bootstrap that was interrupted, and the number of bytes
+   * that had to be fetched from peers. Only valid once the bootstrap callback
+   * is invoked.
+   */
+  uint64_t reused;
+  uint64_t fetched;
+
+  /**
+   * The number of bytes saved by deduplicating the installed platform against
+   * the version before it when the `dedupe` option is set. Only valid once the
+   * bootstrap callback is invoked.
+   */
+  uint64_t deduped;
 
   uv_thread_t thread;
   uv_async_t signal;
+  uv_mutex_t lock;
+
+  appling_path_t executable;
+
+  uv_process_t process;
+  uv_pipe_t pipe;
+
+  char *buffer;
+  size_t buffer_len;
+
+  int handles;
+
+  uv_file file;
+
+  uint64_t downloaded;
+  uint64_t total;
+  uint64_t flushed;
+
+  bool pending;
+  bool done;
 
   int status;
 
@@ -128,6 +236,302 @@ struct appling_bootstrap_s {
   void *data;
 };
 
+/** @version 0 */
+struct appling_bootstrap_options_s {
+  int version;
+
+  /**
+   * Callback for reporting bootstrap progress. The callback is invoked on the
+   * loop passed to `appling_bootstrap()`. If another process is already
+   * bootstrapping the platform into the same directory, the bootstrap instead
+   * waits for that process to finish and reports its progress.
+   *
+   * @since 0
+   */
+  appling_progress_cb progress;
+
+  /**
+   * Path to a local seed to install the platform from instead of downloading
+   * it. The seed is either a directory, holding a single platform version as
+   * found at `by-dkey/<dkey>/<n>` or a platform directory with one or more, or
+   * a tar archive of a platform directory. No network access is performed.
+   *
+   * A seed is trusted input. It is only checked against the key and length
+   * recorded in the checkout file it ships with, not against the contents of
+   * the platform, so only seeds from a trusted source should be installed.
+   *
+   * @since 0
+   */
+  const char *seed;
+
+  /**
+   * The minimum length of the platform to accept from the seed.
+   *
+   * @since 0
+   */
+  uint64_t length;
+
+  /**
+   * The maximum size, in bytes, of the JavaScript heap of the bootstrap
+   * runtime, or 0 for the runtime default.
+   *
+   * @since 0
+   */
+  size_t memory_limit;
+
+  /**
+   * The stack size, in bytes, of the bootstrap thread, or 0 for the system
+   * default.
+   *
+   * @since 0
+   */
+  size_t stack_size;
+
+  /**
+   * Whether to bootstrap in a child process rather than on a thread of the
+   * calling process. All memory used by the bootstrap runtime is then returned
+   * to the OS when the child process exits. Progress and errors are reported
+   * back over a pipe using the same callbacks.
+   *
+   * @since 0
+   */
+  bool spawn;
+
+  /**
+   * The executable to run as the child process when `spawn` is set, or NULL
+   * for the current executable. The executable must pass its arguments to
+   * `appling_bootstrap_main()` before doing anything else.
+   *
+   * @since 0
+   */
+  const char *executable;
+
+  /**
+   * The path to the bootstrap module, or NULL to look for it next to the
+   * current executable. The module holds the runtime used for downloading the
+   * platform and is only loaded once a bootstrap is started.
+   *
+   * @since 0
+   */
+  const char *module;
+
+  /**
+   * The directory in which to keep the storage of the platform, or NULL to
+   * keep it in the platform directory. Blocks are persisted as they arrive, so
+   * a bootstrap that is retried after being interrupted only fetches the
+   * blocks that are still missing.
+   *
+   * Storage left in the platform directory is moved to the given directory if
+   * that doesn't exist yet. If both exist, neither is discarded and the
+   * bootstrap fails with the error of `UV_EEXIST` until one of them has been
+   * removed.
+   *
+   * @since 0
+   */
+  const char *storage;
+
+  /**
+   * Whether to run the bootstrap on a worker shared with all other shared
+   * bootstraps in the process rather than in a runtime of its own. The worker
+   * keeps a single runtime and swarm, and a single store per platform
+   * directory, for all of them, so bootstrapping several keys at once costs
+   * little more than bootstrapping one. The worker uses the default memory
+   * limit and is kept for the remainder of the process, but its swarm and
+   * stores are released while no bootstraps are running. Ignored when `spawn`
+   * is set.
+   *
+   * @since 0
+   */
+  bool shared;
+
+  /**
+   * A comma separated list of `host:port` DHT bootstrap nodes to use instead
+   * of those of the public network, such as the nodes of a local testnet, or
+   * NULL for the public network. Shared bootstraps using the same nodes share
+   * a swarm.
+   *
+   * @since 0
+   */
+  const char *nodes;
+
+  /**
+   * Whether to replace the files of the installed platform that are identical
+   * to those of the version installed before it with clones, on file systems
+   * that support them, or hard links otherwise.
+   *
+   * @since 0
+   */
+  bool dedupe;
+};
+
+struct appling_updater_s {
+  uv_loop_t *loop;
+
+  appling_updater_cb cb;
+  appling_updater_close_cb on_close;
+
+  appling_key_t key;
+  appling_path_t dir;
+  appling_path_t module;
+
+  char nodes[APPLING_NODES_MAX + 1 /* NULL */];
+
+  uint64_t length;
+  uint64_t fork;
+
+  size_t memory_limit;
+
+  uint64_t download_rate;
+  uint64_t disk_rate;
+
+  bool background;
+  bool dedupe;
+
+  /**
+   * The total number of bytes saved by deduplicating new platform versions
+   * against the versions before them when the `dedupe` option is set.
+   */
+  uint64_t deduped;
+
+  uv_async_t signal;
+  uv_mutex_t lock;
+
+  void *runtime;
+
+  int status;
+
+  bool pending;
+  bool paused;
+  bool closing;
+  bool done;
+
+  void *data;
+};
+
+/** @version 0 */
+struct appling_updater_options_s {
+  int version;
+
+  /**
+   * The length of the platform version that is currently installed, if any.
+   * Only versions newer than this are reported.
+   *
+   * @since 0
+   */
+  uint64_t length;
+
+  /**
+   * The fork of the platform version that is currently installed, if any.
+   *
+   * @since 0
+   */
+  uint64_t fork;
+
+  /**
+   * The maximum size, in bytes, of the JavaScript heap of the updater
+   * runtime, or 0 for the runtime default.
+   *
+   * @since 0
+   */
+  size_t memory_limit;
+
+  /**
+   * The path to the bootstrap module, or NULL to look for it next to the
+   * current executable.
+   *
+   * @since 0
+   */
+  const char *module;
+
+  /**
+   * The maximum rate, in bytes per second, at which platform blocks are
+   * downloaded from peers, or 0 for no limit.
+   *
+   * @since 0
+   */
+  uint64_t download_rate;
+
+  /**
+   * The maximum rate, in bytes per second, at which platform files are
+   * written to disk, counting both the downloaded blocks written to storage
+   * and the files copied into the next platform version, or 0 for no limit.
+   *
+   * @since 0
+   */
+  uint64_t disk_rate;
+
+  /**
+   * Whether to run the updater at the lowest CPU and disk I/O priority so that
+   * it never competes with the applications that are running. The priorities
+   * apply to the threads of the updater alone; its work on the libuv thread
+   * pool shared with the rest of the process is instead capped by the rates.
+   *
+   * @since 0
+   */
+  bool background;
+
+  /**
+   * Whether to replace the files of each new platform version that are
+   * identical to those of the version before it with clones, on file systems
+   * that support them, or hard links otherwise.
+   *
+   * @since 0
+   */
+  bool dedupe;
+
+  /**
+   * A comma separated list of `host:port` DHT bootstrap nodes to use instead
+   * of those of the public network, such as the nodes of a local testnet, or
+   * NULL for the public network.
+   *
+   * @since 0
+   */
+  const char *nodes;
+};
+
+struct appling_gc_s {
+  uv_loop_t *loop;
+
+  appling_gc_cb cb;
+
+  appling_lock_t lock;
+
+  uv_work_t work;
+
+  appling_path_t dir;
+
+  size_t retain;
+
+  /**
+   * The number of platform versions that were removed.
+   */
+  size_t removed;
+
+  /**
+   * The number of bytes reclaimed by removing them. Files that are still
+   * linked from elsewhere, such as from a deduplicated version, are not
+   * counted.
+   */
+  uint64_t reclaimed;
+
+  int status;
+
+  void *data;
+};
+
+/** @version 0 */
+struct appling_gc_options_s {
+  int version;
+
+  /**
+   * The number of most recent versions of each platform to keep in addition
+   * to those referenced by `current` and `next`.
+   *
+   * @since 0
+   */
+  size_t retain;
+};
+
 struct appling_paths_s {
   uv_loop_t *loop;
 
@@ -249,6 +653,113 @@ struct appling_launch_info_s {
   const char *name;
 };
 
+struct appling_process_s {
+  uv_loop_t *loop;
+
+  appling_process_cb cb;
+
+  uv_process_t process;
+
+  /**
+   * The ID of the process, or 0 if it could not be spawned.
+   */
+  int pid;
+
+  /**
+   * The exit status of the process, or -1 if it could not be spawned.
+   */
+  int64_t exit_status;
+  int term_signal;
+
+  int status;
+
+  void *data;
+};
+
+struct appling_run_s {
+  uv_loop_t *loop;
+
+  appling_run_cb cb;
+
+  uv_process_t process;
+  uv_timer_t timer;
+
+  uint64_t start;
+  uint64_t timeout;
+
+  int64_t exit_status;
+
+  int status;
+  int pending;
+
+  bool spawned;
+  bool timed_out;
+
+  void *data;
+};
+
+struct appling_batch_s {
+  uv_loop_t *loop;
+
+  appling_batch_cb cb;
+
+  appling_platform_t platform;
+
+  const appling_link_t *links;
+  size_t len;
+
+  int *results;
+
+  appling_run_t *runs;
+  size_t *indices;
+
+  size_t concurrency;
+  uint64_t timeout;
+
+  size_t next;
+  size_t active;
+
+  bool preflight;
+
+  uv_async_t done;
+
+  void *data;
+};
+
+/** @version 0 */
+struct appling_batch_options_s {
+  int version;
+
+  /**
+   * The maximum number of runtimes to run at once. Defaults to 4.
+   *
+   * @since 0
+   */
+  size_t concurrency;
+
+  /**
+   * The number of milliseconds after which a runtime that hasn't exited is
+   * killed, or 0 to wait indefinitely.
+   *
+   * @since 0
+   */
+  uint64_t timeout;
+};
+
+struct appling_session_s {
+  appling_platform_t platform;
+
+  appling_path_t path;
+
+  uv_lib_t library;
+
+  appling_ready_cb ready;
+  appling_preflight_cb preflight;
+  appling_launch_cb launch;
+
+  void *data;
+};
+
 int
 appling_parse(const char *link, appling_link_t *result);
 
@@ -258,14 +769,81 @@ appling_lock(uv_loop_t *loop, appling_lock_t *req, const char *dir, appling_lock
 int
 appling_unlock(uv_loop_t *loop, appling_lock_t *req, appling_unlock_cb cb);
 
+/**
+ * Resolve the platform installed in `dir`. If `dir` is `NULL`, both the store
+ * of the current user and the read-only, system-wide store, if present, are
+ * considered, and the per-user platform is only used if it is newer than the
+ * system-wide one.
+ */
 int
 appling_resolve(uv_loop_t *loop, appling_resolve_t *req, const char *dir, appling_platform_t *platform, appling_resolve_cb cb);
 
+/**
+ * Resolve the platform installed in either `dir` or the system-wide store at
+ * `system`, preferring the one in `system` unless the one in `dir` is newer.
+ * Either may be `NULL` to use the default location.
+ */
+int
+appling_resolve_with_system(uv_loop_t *loop, appling_resolve_t *req, const char *dir, const char *system, appling_platform_t *platform, appling_resolve_cb cb);
+
 int
 appling_paths(uv_loop_t *loop, appling_paths_t *req, const char *dir, appling_paths_cb cb);
 
 int
-appling_bootstrap(uv_loop_t *loop, js_platform_t *js, appling_bootstrap_t *req, const appling_key_t key, const char *dir, appling_bootstrap_cb cb);
+appling_bootstrap(uv_loop_t *loop, appling_bootstrap_t *req, const appling_key_t key, const char *dir, const appling_bootstrap_options_t *options, appling_bootstrap_cb cb);
+
+/**
+ * Run a bootstrap requested by a parent process with the `spawn` option. If
+ * the arguments describe such a bootstrap, the bootstrap is run to completion
+ * and the exit code of the process is returned. Otherwise, `UV_EINVAL` is
+ * returned and the process should continue as normal.
+ */
+int
+appling_bootstrap_main(int argc, char **argv);
+
+/**
+ * Format the time spent in each phase of a bootstrap as a single line, such as
+ * `thread=0.1ms lock=0.0ms setup=31.4ms ... total=5012.9ms`, with `-` for the
+ * phases that were never reached. On return, `len` is set to the length of
+ * the line, excluding the terminating NULL. Returns `UV_ENOBUFS` if the line
+ * does not fit in `len` bytes.
+ */
+int
+appling_bootstrap_format_timing(const appling_bootstrap_timing_t *timing, char *buf, size_t *len);
+
+/**
+ * Start a long-lived updater that keeps a single runtime, and its connections
+ * to peers, alive between checks for platform updates. The callback is invoked
+ * after every check, and whenever a new platform version has been installed in
+ * the background, with the latest known version of the platform.
+ */
+int
+appling_updater_open(uv_loop_t *loop, appling_updater_t *updater, const appling_key_t key, const char *dir, const appling_updater_options_t *options, appling_updater_cb cb);
+
+int
+appling_updater_check(appling_updater_t *updater);
+
+/**
+ * Suspend any download in progress, and any checks made in the meantime,
+ * until the updater is resumed.
+ */
+int
+appling_updater_pause(appling_updater_t *updater);
+
+int
+appling_updater_resume(appling_updater_t *updater);
+
+int
+appling_updater_close(appling_updater_t *updater, appling_updater_close_cb cb);
+
+/**
+ * Remove the platform versions that are no longer referenced from a platform
+ * directory. The exclusive platform lock is held for the duration of the
+ * collection, which is carried out off the loop, and resolves in the same
+ * process wait for the removal to finish rather than racing it.
+ */
+int
+appling_gc(uv_loop_t *loop, appling_gc_t *req, const char *dir, const appling_gc_options_t *options, appling_gc_cb cb);
 
 int
 appling_ready(const appling_platform_t *platform, const appling_link_t *link);
@@ -276,9 +854,126 @@ appling_preflight(const appling_platform_t *platform, const appling_link_t *link
 int
 appling_launch(const appling_platform_t *platform, const appling_app_t *app, const appling_link_t *link, const char *name);
 
+/**
+ * Hand the launch to a launcher service, a platform runtime started ahead of
+ * time that launches applications without starting a runtime of its own,
+ * falling back to `appling_launch()` if no service takes it. Unlike
+ * `appling_launch()`, this returns 0 without replacing the current process
+ * when the service took the launch.
+ *
+ * The service listens on a UNIX socket at the path named by the
+ * `PEAR_LAUNCHER_SOCKET` environment variable, or else at
+ * `pear-launcher.sock` in `XDG_RUNTIME_DIR`, or else at `launcher.sock` in the
+ * platform directory of the user. It is only used if it runs as the same user
+ * as the caller, and is given a second to reply. Services are not used on
+ * Windows.
+ *
+ * The caller writes a single message, a compact encoded uint with the length
+ * of the rest of the message, followed by:
+ *
+ *   - the link as a compact encoded utf8 string, such as `pear://<id>`
+ *   - the path of the application shell as a compact encoded utf8 string
+ *   - the name of the application as a compact encoded utf8 string, empty if
+ *     none was given
+ *   - the key of the platform as 32 raw bytes
+ *   - the length and fork of the platform as compact encoded uints
+ *
+ * The service replies with a single byte, 0 if it took the launch, or any
+ * other value if it didn't, such as when it runs another version of the
+ * platform.
+ */
+int
+appling_launch_service(const appling_platform_t *platform, const appling_app_t *app, const appling_link_t *link, const char *name);
+
+/**
+ * Load the entry library of a platform once for any number of readiness
+ * checks, preflights, and launches, rather than loading and unloading it for
+ * each of them, until the session is closed.
+ */
+int
+appling_session_open(appling_session_t *session, const appling_platform_t *platform);
+
+int
+appling_session_ready(appling_session_t *session, const appling_link_t *link);
+
+/**
+ * Run the preflight of the platform runtime for a link, forwarding the
+ * progress reported by the runtime to the callback, if any, no more than every
+ * so often. The callback is invoked on the calling thread before the preflight
+ * returns.
+ */
+int
+appling_session_preflight(appling_session_t *session, const appling_link_t *link, appling_progress_cb progress);
+
+int
+appling_session_launch(appling_session_t *session, const appling_app_t *app, const appling_link_t *link, const char *name);
+
+void
+appling_session_close(appling_session_t *session);
+
+/**
+ * Run the readiness check of the platform runtime for a link on the loop
+ * rather than blocking the calling thread. If `timeout` is nonzero, the
+ * runtime is killed if it hasn't exited within that many milliseconds, and the
+ * callback is invoked with `UV_ETIMEDOUT`. Otherwise, the callback is invoked
+ * with 0 and the exit status of the runtime, which is 0 if the link is ready,
+ * along with the wall-clock duration of the run in nanoseconds.
+ *
+ * Unlike `appling_ready()`, the runtime is spawned directly rather than through
+ * the entry library of the platform, using the command line that this version
+ * of the library knows the runtime by.
+ */
+int
+appling_run_ready(uv_loop_t *loop, appling_run_t *req, const appling_platform_t *platform, const appling_link_t *link, uint64_t timeout, appling_run_cb cb);
+
+/**
+ * Run the preflight of the platform runtime for a link on the loop, as with
+ * `appling_run_ready()`.
+ */
+int
+appling_run_preflight(uv_loop_t *loop, appling_run_t *req, const appling_platform_t *platform, const appling_link_t *link, uint64_t timeout, appling_run_cb cb);
+
+/**
+ * Launch an application with the platform runtime as a child process on the
+ * loop, as with `appling_run_ready()`, rather than replacing the current
+ * process.
+ */
+int
+appling_run_launch(uv_loop_t *loop, appling_run_t *req, const appling_platform_t *platform, const appling_app_t *app, const appling_link_t *link, uint64_t timeout, appling_run_cb cb);
+
+/**
+ * Check the readiness of many links on the loop, running no more than a few
+ * runtimes at once. Once every link has been checked, `results[i]` holds 1 if
+ * `links[i]` is ready, 0 if it isn't, or a negative value if it couldn't be
+ * checked, and the callback is invoked. Both arrays must outlive the request.
+ * Links found ready in the ready cache are answered without running it.
+ */
+int
+appling_batch_ready(uv_loop_t *loop, appling_batch_t *req, const appling_platform_t *platform, const appling_link_t *links, size_t len, int *results, const appling_batch_options_t *options, appling_batch_cb cb);
+
+/**
+ * Run the preflight of many links on the loop, as with `appling_batch_ready()`.
+ * Once every preflight has finished, `results[i]` holds 0 if the preflight of
+ * `links[i]` succeeded, or a negative value if it didn't. The runtime takes a
+ * single link per invocation, so every link still costs a runtime of its own;
+ * the batch only bounds how many of them run at once.
+ */
+int
+appling_batch_preflight(uv_loop_t *loop, appling_batch_t *req, const appling_platform_t *platform, const appling_link_t *links, size_t len, int *results, const appling_batch_options_t *options, appling_batch_cb cb);
+
 int
 appling_open(const appling_app_t *app, const char *argument);
 
+#if defined(APPLING_OS_LINUX)
+/**
+ * Open an application as with `appling_open()`, reaping it on the loop. The
+ * callback is invoked once the process has exited with its exit status and
+ * terminating signal, or with a negative status if it could not be spawned.
+ */
+int
+appling_open_process(uv_loop_t *loop, appling_process_t *process, const appling_app_t *app, const char *argument, appling_process_cb cb);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
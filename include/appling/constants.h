@@ -14,6 +14,8 @@ static const char *appling_platform_dir = APPLING_PLATFORM_DIR;
 
 static const char *appling_platform_entry = APPLING_PLATFORM_ENTRY;
 
+static const char *appling_bootstrap_module = APPLING_BOOTSTRAP_MODULE;
+
 static const char *appling_platform_current = APPLING_PLATFORM_CURRENT;
 
 static const char *appling_platform_next = APPLING_PLATFORM_NEXT;
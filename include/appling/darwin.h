@@ -8,6 +8,10 @@
 
 #define APPLING_PLATFORM_DIR "Library/Application Support/pear"
 
+#define APPLING_PLATFORM_SYSTEM_DIR "/Library/Application Support/pear"
+
 #define APPLING_PLATFORM_ENTRY "launch.dylib"
 
+#define APPLING_BOOTSTRAP_MODULE "bootstrap.dylib"
+
 #endif // APPLING_MAC_H
@@ -8,6 +8,10 @@
 
 #define APPLING_PLATFORM_DIR ".config/pear"
 
+#define APPLING_PLATFORM_SYSTEM_DIR "/opt/pear"
+
 #define APPLING_PLATFORM_ENTRY "launch.so"
 
+#define APPLING_BOOTSTRAP_MODULE "bootstrap.so"
+
 #endif // APPLING_LINUX_H
@@ -8,6 +8,11 @@
 
 #define APPLING_PLATFORM_DIR "AppData\\Roaming\\pear"
 
+// Relative to %PROGRAMDATA%
+#define APPLING_PLATFORM_SYSTEM_DIR "pear"
+
 #define APPLING_PLATFORM_ENTRY "launch.dll"
 
+#define APPLING_BOOTSTRAP_MODULE "bootstrap.dll"
+
 #endif // APPLING_WIN_H
@@ -0,0 +1,190 @@
+#include <log.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#include "ready-cache.h"
+
+// The runtime takes a single link per invocation and offers no way to hand
+// more links to one that is already running, so a batch is run as a pool of
+// runtimes, each taking the next link as the previous one exits. Every link
+// that isn't answered by the ready cache still costs a cold runtime; the pool
+// only overlaps them, bounding the wall time of many checks without starting
+// as many runtimes at once as there are links.
+
+#define APPLING_BATCH_CONCURRENCY 4
+
+static void
+appling_batch__start(appling_batch_t *req);
+
+static int
+appling_batch__result(appling_batch_t *req, int status, int64_t exit_status) {
+  if (status < 0) return status;
+
+  if (req->preflight) return exit_status == 0 ? 0 : -1;
+
+  return exit_status == 0;
+}
+
+static void
+appling_batch__on_run(appling_run_t *run, int status, int64_t exit_status, uint64_t duration) {
+  appling_batch_t *req = (appling_batch_t *) run->data;
+
+  size_t slot = run - req->runs;
+
+  size_t i = req->indices[slot];
+
+  req->indices[slot] = SIZE_MAX;
+
+  int result = appling_batch__result(req, status, exit_status);
+
+  log_debug("appling_batch() link %s finished with %d after %llu ms", req->links[i].id, result, (unsigned long long) (duration / 1000000));
+
+  req->results[i] = result;
+
+  if (!req->preflight && result == 1) appling_ready_cache__add(&req->platform, &req->links[i]);
+
+  req->active--;
+
+  appling_batch__start(req);
+}
+
+static void
+appling_batch__on_done_close(uv_handle_t *handle) {
+  appling_batch_t *req = (appling_batch_t *) handle->data;
+
+  free(req->runs);
+  free(req->indices);
+
+  req->runs = NULL;
+  req->indices = NULL;
+
+  if (req->cb) req->cb(req, 0);
+}
+
+static void
+appling_batch__on_done(uv_async_t *handle) {
+  uv_close((uv_handle_t *) handle, appling_batch__on_done_close);
+}
+
+static void
+appling_batch__start(appling_batch_t *req) {
+  int err;
+
+  for (size_t slot = 0; slot < req->concurrency; slot++) {
+    if (req->indices[slot] != SIZE_MAX) continue; // Still running
+
+    appling_run_t *run = &req->runs[slot];
+
+    run->data = (void *) req;
+
+    while (req->next < req->len) {
+      size_t i = req->next++;
+
+      const appling_link_t *link = &req->links[i];
+
+      if (req->preflight) {
+        // Whatever the outcome, the preflight may have changed whether the
+        // link is ready, so have it checked again.
+        appling_ready_cache__remove(&req->platform, link);
+
+        err = appling_run_preflight(req->loop, run, &req->platform, link, req->timeout, appling_batch__on_run);
+      } else {
+        if (appling_ready_cache__get(&req->platform, link)) {
+          log_debug("appling_batch() link %s found ready in cache", link->id);
+
+          req->results[i] = 1;
+          continue;
+        }
+
+        err = appling_run_ready(req->loop, run, &req->platform, link, req->timeout, appling_batch__on_run);
+      }
+
+      if (err < 0) {
+        req->results[i] = err;
+        continue;
+      }
+
+      req->indices[slot] = i;
+      req->active++;
+      break;
+    }
+  }
+
+  if (req->active > 0 || req->next < req->len) return;
+
+  // Links answered without a runtime may finish the batch before it has even
+  // been returned to the caller, so the callback is deferred to the loop.
+  uv_async_send(&req->done);
+}
+
+static int
+appling_batch__run(uv_loop_t *loop, appling_batch_t *req, const appling_platform_t *platform, const appling_link_t *links, size_t len, int *results, const appling_batch_options_t *options, bool preflight, appling_batch_cb cb) {
+  int err;
+
+  if (len == 0) return UV_EINVAL;
+
+  req->loop = loop;
+  req->cb = cb;
+  req->links = links;
+  req->len = len;
+  req->results = results;
+  req->concurrency = APPLING_BATCH_CONCURRENCY;
+  req->timeout = 0;
+  req->next = 0;
+  req->active = 0;
+  req->preflight = preflight;
+
+  memcpy(&req->platform, platform, sizeof(appling_platform_t));
+
+  if (options) {
+    if (options->concurrency) req->concurrency = options->concurrency;
+
+    req->timeout = options->timeout;
+  }
+
+  if (req->concurrency > len) req->concurrency = len;
+
+  req->runs = malloc(req->concurrency * sizeof(appling_run_t));
+  req->indices = malloc(req->concurrency * sizeof(size_t));
+
+  if (req->runs == NULL || req->indices == NULL) {
+    free(req->runs);
+    free(req->indices);
+
+    return UV_ENOMEM;
+  }
+
+  for (size_t slot = 0; slot < req->concurrency; slot++) req->indices[slot] = SIZE_MAX;
+
+  err = uv_async_init(loop, &req->done, appling_batch__on_done);
+
+  if (err < 0) {
+    free(req->runs);
+    free(req->indices);
+
+    return err;
+  }
+
+  req->done.data = (void *) req;
+
+  log_debug("appling_batch() running %zu links, %zu at a time", len, req->concurrency);
+
+  appling_batch__start(req);
+
+  return 0;
+}
+
+int
+appling_batch_ready(uv_loop_t *loop, appling_batch_t *req, const appling_platform_t *platform, const appling_link_t *links, size_t len, int *results, const appling_batch_options_t *options, appling_batch_cb cb) {
+  return appling_batch__run(loop, req, platform, links, len, results, options, false, cb);
+}
+
+int
+appling_batch_preflight(uv_loop_t *loop, appling_batch_t *req, const appling_platform_t *platform, const appling_link_t *links, size_t len, int *results, const appling_batch_options_t *options, appling_batch_cb cb) {
+  return appling_batch__run(loop, req, platform, links, len, results, options, true, cb);
+}
@@ -0,0 +1,140 @@
+#ifndef APPLING_BLAKE2B_H
+#define APPLING_BLAKE2B_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Keyed BLAKE2b as specified in RFC 7693, enough to derive the discovery key
+// of a platform from its public key without pulling in a crypto library.
+
+#define APPLING_BLAKE2B_BLOCK_LEN 128
+
+static const uint64_t appling_blake2b__iv[8] = {
+  0x6a09e667f3bcc908ULL,
+  0xbb67ae8584caa73bULL,
+  0x3c6ef372fe94f82bULL,
+  0xa54ff53a5f1d36f1ULL,
+  0x510e527fade682d1ULL,
+  0x9b05688c2b3e6c1fULL,
+  0x1f83d9abfb41bd6bULL,
+  0x5be0cd19137e2179ULL,
+};
+
+static const uint8_t appling_blake2b__sigma[12][16] = {
+  {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+  {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+  {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4},
+  {7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+  {9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13},
+  {2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+  {12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11},
+  {13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+  {6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5},
+  {10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0},
+  {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+  {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+};
+
+static inline uint64_t
+appling_blake2b__rotr(uint64_t x, int n) {
+  return (x >> n) | (x << (64 - n));
+}
+
+static inline void
+appling_blake2b__mix(uint64_t v[16], int a, int b, int c, int d, uint64_t x, uint64_t y) {
+  v[a] = v[a] + v[b] + x;
+  v[d] = appling_blake2b__rotr(v[d] ^ v[a], 32);
+  v[c] = v[c] + v[d];
+  v[b] = appling_blake2b__rotr(v[b] ^ v[c], 24);
+  v[a] = v[a] + v[b] + y;
+  v[d] = appling_blake2b__rotr(v[d] ^ v[a], 16);
+  v[c] = v[c] + v[d];
+  v[b] = appling_blake2b__rotr(v[b] ^ v[c], 63);
+}
+
+static inline void
+appling_blake2b__compress(uint64_t h[8], const uint8_t block[APPLING_BLAKE2B_BLOCK_LEN], uint64_t t, int last) {
+  uint64_t v[16], m[16];
+
+  for (int i = 0; i < 16; i++) {
+    m[i] = 0;
+
+    for (int j = 0; j < 8; j++) m[i] |= (uint64_t) block[i * 8 + j] << (8 * j);
+  }
+
+  for (int i = 0; i < 8; i++) {
+    v[i] = h[i];
+    v[i + 8] = appling_blake2b__iv[i];
+  }
+
+  v[12] ^= t;
+
+  if (last) v[14] = ~v[14];
+
+  for (int i = 0; i < 12; i++) {
+    const uint8_t *s = appling_blake2b__sigma[i];
+
+    appling_blake2b__mix(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+    appling_blake2b__mix(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+    appling_blake2b__mix(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+    appling_blake2b__mix(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+    appling_blake2b__mix(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+    appling_blake2b__mix(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+    appling_blake2b__mix(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+    appling_blake2b__mix(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+  }
+
+  for (int i = 0; i < 8; i++) h[i] ^= v[i] ^ v[i + 8];
+}
+
+// Hash `len` bytes of `data` with the given key, of at most 64 bytes, into
+// `out_len` bytes of `out`, of at most 64 bytes.
+static inline void
+appling_blake2b__hash(uint8_t *out, size_t out_len, const uint8_t *data, size_t len, const uint8_t *key, size_t key_len) {
+  uint64_t h[8];
+
+  for (int i = 0; i < 8; i++) h[i] = appling_blake2b__iv[i];
+
+  h[0] ^= 0x01010000 ^ (key_len << 8) ^ out_len;
+
+  uint8_t block[APPLING_BLAKE2B_BLOCK_LEN];
+
+  uint64_t t = 0;
+
+  if (key_len > 0) {
+    memset(block, 0, sizeof(block));
+    memcpy(block, key, key_len);
+
+    t += APPLING_BLAKE2B_BLOCK_LEN;
+
+    if (len == 0) {
+      appling_blake2b__compress(h, block, t, 1);
+
+      goto done;
+    }
+
+    appling_blake2b__compress(h, block, t, 0);
+  }
+
+  while (len > APPLING_BLAKE2B_BLOCK_LEN) {
+    t += APPLING_BLAKE2B_BLOCK_LEN;
+
+    appling_blake2b__compress(h, data, t, 0);
+
+    data += APPLING_BLAKE2B_BLOCK_LEN;
+    len -= APPLING_BLAKE2B_BLOCK_LEN;
+  }
+
+  memset(block, 0, sizeof(block));
+  memcpy(block, data, len);
+
+  t += len;
+
+  appling_blake2b__compress(h, block, t, 1);
+
+done:
+  for (size_t i = 0; i < out_len; i++) out[i] = (uint8_t) (h[i / 8] >> (8 * (i % 8)));
+}
+
+#endif // APPLING_BLAKE2B_H
@@ -0,0 +1,448 @@
+#include <assert.h>
+#include <compact.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utf.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#include "bootstrap-process.h"
+
+// A bootstrap in a child process reports back to its parent over a pipe
+// inherited as file descriptor 3. Each message is a compact encoded length
+// followed by a type and its fields.
+
+#define APPLING_BOOTSTRAP_FLAG "--appling-bootstrap"
+#define APPLING_BOOTSTRAP_FD   3
+
+enum {
+  appling_bootstrap__message_progress = 1,
+  appling_bootstrap__message_error = 2,
+  appling_bootstrap__message_exit = 3,
+  appling_bootstrap__message_timing = 4,
+  appling_bootstrap__message_transfer = 5,
+};
+
+static struct {
+  uv_loop_t loop;
+  int status;
+} appling_bootstrap__child;
+
+static void
+appling_bootstrap__send(uintmax_t type, const uintmax_t *values, size_t len, const char *error) {
+  int err;
+
+  compact_state_t message = {0, 0, NULL};
+
+  compact_preencode_uint(&message, type);
+
+  utf8_string_view_t string;
+
+  if (error) {
+    string = (utf8_string_view_t) {.data = (const utf8_t *) error, .len = strlen(error)};
+
+    compact_preencode_utf8(&message, string);
+  } else {
+    for (size_t i = 0; i < len; i++) compact_preencode_uint(&message, values[i]);
+  }
+
+  compact_state_t state = {0, 0, NULL};
+
+  compact_preencode_uint(&state, message.end);
+
+  state.end += message.end;
+  state.buffer = malloc(state.end);
+
+  if (state.buffer == NULL) return;
+
+  compact_encode_uint(&state, message.end);
+  compact_encode_uint(&state, type);
+
+  if (error) {
+    compact_encode_utf8(&state, string);
+  } else {
+    for (size_t i = 0; i < len; i++) compact_encode_uint(&state, values[i]);
+  }
+
+  uv_buf_t buf = uv_buf_init((char *) state.buffer, state.end);
+
+  while (buf.len > 0) {
+    uv_fs_t fs;
+    err = uv_fs_write(&appling_bootstrap__child.loop, &fs, APPLING_BOOTSTRAP_FD, &buf, 1, -1, NULL);
+    uv_fs_req_cleanup(&fs);
+
+    if (err <= 0) break; // The parent has gone away, keep bootstrapping
+
+    buf.base += err;
+    buf.len -= err;
+  }
+
+  free(state.buffer);
+}
+
+static void
+appling_bootstrap__on_child_progress(uint64_t downloaded, uint64_t total) {
+  appling_bootstrap__send(appling_bootstrap__message_progress, (uintmax_t[]) {downloaded, total}, 2, NULL);
+}
+
+static void
+appling_bootstrap__on_child_bootstrap(appling_bootstrap_t *req, int status) {
+  if (req->error) appling_bootstrap__send(appling_bootstrap__message_error, NULL, 0, req->error);
+
+  // The timestamps are taken from the same monotonic clock in both processes
+  // and so are sent as is.
+  const appling_bootstrap_timing_t *timing = &req->timing;
+
+  uintmax_t phases[] = {
+    timing->thread,
+    timing->lock,
+    timing->setup,
+    timing->load,
+    timing->connect,
+    timing->transfer,
+    timing->run,
+    timing->teardown,
+    timing->end,
+  };
+
+  appling_bootstrap__send(appling_bootstrap__message_timing, phases, sizeof(phases) / sizeof(phases[0]), NULL);
+
+  appling_bootstrap__send(appling_bootstrap__message_transfer, (uintmax_t[]) {req->reused, req->fetched, req->deduped}, 3, NULL);
+
+  appling_bootstrap__send(appling_bootstrap__message_exit, (uintmax_t[]) {(uintmax_t) status, req->peak_rss}, 2, NULL);
+
+  appling_bootstrap__child.status = status;
+}
+
+static int
+appling_bootstrap__hex(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+int
+appling_bootstrap_main(int argc, char **argv) {
+  int err;
+
+  if (argc < 2 || strcmp(argv[1], APPLING_BOOTSTRAP_FLAG) != 0) return UV_EINVAL;
+
+  if (argc != 12 || strlen(argv[2]) != APPLING_KEY_LEN * 2) return 1;
+
+  appling_key_t key;
+
+  for (size_t i = 0; i < APPLING_KEY_LEN; i++) {
+    int hi = appling_bootstrap__hex(argv[2][i * 2]);
+    int lo = appling_bootstrap__hex(argv[2][i * 2 + 1]);
+
+    if (hi < 0 || lo < 0) return 1;
+
+    key[i] = (uint8_t) (hi << 4 | lo);
+  }
+
+  err = uv_loop_init(&appling_bootstrap__child.loop);
+  if (err < 0) return 1;
+
+  appling_bootstrap__child.status = 1;
+
+  appling_bootstrap_options_t options = {
+    .version = 0,
+    .progress = appling_bootstrap__on_child_progress,
+    .seed = argv[4][0] ? argv[4] : NULL,
+    .length = strtoull(argv[5], NULL, 10),
+    .memory_limit = (size_t) strtoull(argv[6], NULL, 10),
+    .stack_size = (size_t) strtoull(argv[7], NULL, 10),
+    .module = argv[8][0] ? argv[8] : NULL,
+    .storage = argv[9][0] ? argv[9] : NULL,
+    .nodes = argv[10][0] ? argv[10] : NULL,
+    .dedupe = strcmp(argv[11], "1") == 0,
+  };
+
+  appling_bootstrap_t req;
+  err = appling_bootstrap(&appling_bootstrap__child.loop, &req, key, argv[3], &options, appling_bootstrap__on_child_bootstrap);
+
+  if (err == 0) {
+    err = uv_run(&appling_bootstrap__child.loop, UV_RUN_DEFAULT);
+    assert(err == 0);
+  } else {
+    appling_bootstrap__send(appling_bootstrap__message_error, NULL, 0, uv_strerror(err));
+  }
+
+  err = uv_loop_close(&appling_bootstrap__child.loop);
+  assert(err == 0);
+
+  return appling_bootstrap__child.status;
+}
+
+static void
+appling_bootstrap__on_close(uv_handle_t *handle) {
+  appling_bootstrap_t *req = (appling_bootstrap_t *) handle->data;
+
+  if (--req->handles > 0) return;
+
+  if (req->status < 0) {
+    // The child exited cleanly without ever reporting a result, such as when
+    // the executable doesn't hand the bootstrap flag to
+    // `appling_bootstrap_main()`, so nothing was installed.
+    static const char *message = "bootstrap process exited without a result";
+
+    if (req->error == NULL) {
+      req->error = calloc(strlen(message) + 1 /* NULL */, sizeof(char));
+
+      if (req->error) strcpy(req->error, message);
+    }
+
+    req->status = 1;
+  }
+
+  if (req->cb) req->cb(req, req->status);
+
+  if (req->error) free(req->error);
+
+  if (req->buffer) free(req->buffer);
+}
+
+static void
+appling_bootstrap__on_message(appling_bootstrap_t *req, compact_state_t *state) {
+  int err;
+
+  uintmax_t type;
+  err = compact_decode_uint(state, &type);
+  if (err < 0) return;
+
+  switch (type) {
+  case appling_bootstrap__message_progress: {
+    uintmax_t downloaded, total;
+
+    err = compact_decode_uint(state, &downloaded);
+    if (err < 0) return;
+
+    err = compact_decode_uint(state, &total);
+    if (err < 0) return;
+
+    if (req->progress) req->progress(downloaded, total);
+    break;
+  }
+
+  case appling_bootstrap__message_error: {
+    utf8_string_view_t error;
+    err = compact_decode_utf8(state, &error);
+    if (err < 0) return;
+
+    if (req->error) free(req->error);
+
+    req->error = calloc(error.len + 1 /* NULL */, sizeof(char));
+
+    if (req->error) memcpy(req->error, error.data, error.len);
+    break;
+  }
+
+  case appling_bootstrap__message_exit: {
+    uintmax_t status, peak_rss;
+
+    err = compact_decode_uint(state, &status);
+    if (err < 0) return;
+
+    err = compact_decode_uint(state, &peak_rss);
+    if (err < 0) return;
+
+    // A child that exited with a failure can't be overruled by its message.
+    if (req->status < 0) req->status = (int) status;
+
+    req->peak_rss = (size_t) peak_rss;
+    break;
+  }
+
+  case appling_bootstrap__message_timing: {
+    appling_bootstrap_timing_t *timing = &req->timing;
+
+    // The start of the bootstrap is kept from this process so that the time
+    // taken to spawn the child process is accounted for.
+    uint64_t *fields[] = {
+      &timing->thread,
+      &timing->lock,
+      &timing->setup,
+      &timing->load,
+      &timing->connect,
+      &timing->transfer,
+      &timing->run,
+      &timing->teardown,
+      &timing->end,
+    };
+
+    for (size_t i = 0, n = sizeof(fields) / sizeof(fields[0]); i < n; i++) {
+      uintmax_t value;
+
+      err = compact_decode_uint(state, &value);
+      if (err < 0) return;
+
+      *fields[i] = value;
+    }
+    break;
+  }
+
+  case appling_bootstrap__message_transfer: {
+    uintmax_t reused, fetched, deduped;
+
+    err = compact_decode_uint(state, &reused);
+    if (err < 0) return;
+
+    err = compact_decode_uint(state, &fetched);
+    if (err < 0) return;
+
+    err = compact_decode_uint(state, &deduped);
+    if (err < 0) return;
+
+    req->reused = reused;
+    req->fetched = fetched;
+    req->deduped = deduped;
+    break;
+  }
+  }
+}
+
+static void
+appling_bootstrap__on_alloc(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
+  appling_bootstrap_t *req = (appling_bootstrap_t *) handle->data;
+
+  char *buffer = realloc(req->buffer, req->buffer_len + suggested_size);
+
+  if (buffer == NULL) {
+    *buf = uv_buf_init(NULL, 0);
+    return;
+  }
+
+  req->buffer = buffer;
+
+  *buf = uv_buf_init(buffer + req->buffer_len, suggested_size);
+}
+
+static void
+appling_bootstrap__on_read(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf) {
+  int err;
+
+  appling_bootstrap_t *req = (appling_bootstrap_t *) stream->data;
+
+  if (nread < 0) {
+    uv_close((uv_handle_t *) stream, appling_bootstrap__on_close);
+    return;
+  }
+
+  req->buffer_len += nread;
+
+  compact_state_t state = {0, req->buffer_len, (uint8_t *) req->buffer};
+
+  while (state.start < state.end) {
+    size_t start = state.start;
+
+    uintmax_t len;
+    err = compact_decode_uint(&state, &len);
+
+    if (err < 0 || state.end - state.start < len) {
+      state.start = start; // Wait for the rest of the message
+      break;
+    }
+
+    compact_state_t message = {state.start, state.start + len, state.buffer};
+
+    appling_bootstrap__on_message(req, &message);
+
+    state.start += len;
+  }
+
+  req->buffer_len -= state.start;
+
+  memmove(req->buffer, req->buffer + state.start, req->buffer_len);
+}
+
+static void
+appling_bootstrap__on_exit(uv_process_t *handle, int64_t exit_status, int term_signal) {
+  appling_bootstrap_t *req = (appling_bootstrap_t *) handle->data;
+
+  if (exit_status != 0) req->status = (int) exit_status;
+  else if (term_signal != 0) req->status = 1;
+
+  uv_close((uv_handle_t *) handle, appling_bootstrap__on_close);
+}
+
+int
+appling_bootstrap__spawn(appling_bootstrap_t *req) {
+  int err;
+
+  char key[APPLING_KEY_LEN * 2 + 1 /* NULL */];
+
+  for (size_t i = 0; i < APPLING_KEY_LEN; i++) {
+    snprintf(&key[i * 2], 3, "%02x", req->key[i]);
+  }
+
+  // The bootstrap is failed until the child reports otherwise in its exit
+  // message, as a clean exit alone says nothing about what was installed.
+  req->status = -1;
+
+  char length[32], memory_limit[32], stack_size[32];
+
+  snprintf(length, sizeof(length), "%" PRIu64, req->length);
+  snprintf(memory_limit, sizeof(memory_limit), "%" PRIu64, (uint64_t) req->memory_limit);
+  snprintf(stack_size, sizeof(stack_size), "%" PRIu64, (uint64_t) req->stack_size);
+
+  char *args[] = {
+    req->executable,
+    APPLING_BOOTSTRAP_FLAG,
+    key,
+    req->dir,
+    req->seed,
+    length,
+    memory_limit,
+    stack_size,
+    req->module,
+    req->storage,
+    req->nodes,
+    req->dedupe ? "1" : "0",
+    NULL,
+  };
+
+  req->process.data = (void *) req;
+  req->pipe.data = (void *) req;
+
+  err = uv_pipe_init(req->loop, &req->pipe, 0);
+  if (err < 0) return err;
+
+  uv_stdio_container_t stdio[] = {
+    {.flags = UV_IGNORE},
+    {.flags = UV_INHERIT_FD, .data.fd = 1},
+    {.flags = UV_INHERIT_FD, .data.fd = 2},
+    {.flags = UV_CREATE_PIPE | UV_WRITABLE_PIPE, .data.stream = (uv_stream_t *) &req->pipe},
+  };
+
+  uv_process_options_t options = {
+    .exit_cb = appling_bootstrap__on_exit,
+    .file = req->executable,
+    .args = args,
+    .flags = UV_PROCESS_WINDOWS_HIDE,
+    .stdio_count = 4,
+    .stdio = stdio,
+  };
+
+  err = uv_spawn(req->loop, &req->process, &options);
+
+  if (err < 0) {
+    uv_close((uv_handle_t *) &req->process, NULL);
+    uv_close((uv_handle_t *) &req->pipe, NULL);
+
+    return err;
+  }
+
+  req->handles = 2;
+
+  err = uv_read_start((uv_stream_t *) &req->pipe, appling_bootstrap__on_alloc, appling_bootstrap__on_read);
+
+  if (err < 0) {
+    uv_close((uv_handle_t *) &req->pipe, appling_bootstrap__on_close);
+  }
+
+  return 0;
+}
@@ -0,0 +1,9 @@
+#ifndef APPLING_BOOTSTRAP_PROCESS_H
+#define APPLING_BOOTSTRAP_PROCESS_H
+
+#include "../include/appling.h"
+
+int
+appling_bootstrap__spawn(appling_bootstrap_t *req);
+
+#endif // APPLING_BOOTSTRAP_PROCESS_H
@@ -0,0 +1,684 @@
+#include <assert.h>
+#include <bare.h>
+#include <compact.h>
+#include <js.h>
+#include <log.h>
+#include <path.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utf.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#if defined(APPLING_OS_WIN32)
+#include <windows.h>
+#else
+#include <errno.h>
+#include <sys/file.h>
+#endif
+
+#include "bootstrap-runtime.h"
+#include "bootstrap-worker.h"
+#include "dedupe.h"
+#include "fs-sync.h"
+#include "runtime.h"
+#include "seed.h"
+#include "bootstrap.bundle.h"
+
+#if defined(APPLING_COMPRESSED_BUNDLE)
+#include "lz4.h"
+#endif
+
+enum {
+  appling_bootstrap__running = 0,
+  appling_bootstrap__succeeded = 1,
+  appling_bootstrap__failed = 2,
+};
+
+static int
+appling_bootstrap__try_lock(uv_file file) {
+#if defined(APPLING_OS_WIN32)
+  // Lock a byte well past the end of the state record as Windows locks are
+  // mandatory and would otherwise prevent waiters from reading the record.
+  OVERLAPPED overlapped;
+  ZeroMemory(&overlapped, sizeof(overlapped));
+
+  overlapped.OffsetHigh = MAXLONG;
+
+  BOOL success = LockFileEx((HANDLE) uv_get_osfhandle(file), LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0, 1, 0, &overlapped);
+
+  if (success) return 0;
+
+  DWORD err = GetLastError();
+
+  return err == ERROR_LOCK_VIOLATION || err == ERROR_IO_PENDING ? UV_EAGAIN : uv_translate_sys_error(err);
+#else
+  int res = flock(file, LOCK_EX | LOCK_NB);
+
+  return res == 0 ? 0 : uv_translate_sys_error(errno);
+#endif
+}
+
+static const appling_bootstrap_host_t *appling_bootstrap__host;
+
+// The state record holds the state of the bootstrap, its progress, and its
+// status, followed for a failed bootstrap by the error of the leader so that
+// waiters adopting the result report the same failure.
+
+#define APPLING_BOOTSTRAP_RECORD_MAX 4096
+#define APPLING_BOOTSTRAP_ERROR_MAX  (APPLING_BOOTSTRAP_RECORD_MAX - 64)
+
+static void
+appling_bootstrap__write(appling_bootstrap_t *req, uv_loop_t *loop, uintmax_t state, uintmax_t status) {
+  int err;
+
+  if (req->file < 0) return;
+
+  // Progress is reported from the bootstrap thread, or from the worker for a
+  // shared bootstrap, and stored under the lock of the request.
+  uv_mutex_lock(&req->lock);
+
+  uint64_t downloaded = req->downloaded;
+  uint64_t total = req->total;
+
+  uv_mutex_unlock(&req->lock);
+
+  utf8_string_view_t error = {.data = (const utf8_t *) "", .len = 0};
+
+  if (req->error) {
+    error.data = (const utf8_t *) req->error;
+    error.len = strlen(req->error);
+
+    if (error.len > APPLING_BOOTSTRAP_ERROR_MAX) error.len = APPLING_BOOTSTRAP_ERROR_MAX;
+  }
+
+  uint8_t data[APPLING_BOOTSTRAP_RECORD_MAX];
+
+  compact_state_t encoder = {0, 0, data};
+
+  compact_preencode_uint(&encoder, state);
+  compact_preencode_uint(&encoder, downloaded);
+  compact_preencode_uint(&encoder, total);
+  compact_preencode_uint(&encoder, status);
+
+  if (state == appling_bootstrap__failed) compact_preencode_utf8(&encoder, error);
+
+  compact_encode_uint(&encoder, state);
+  compact_encode_uint(&encoder, downloaded);
+  compact_encode_uint(&encoder, total);
+  compact_encode_uint(&encoder, status);
+
+  if (state == appling_bootstrap__failed) compact_encode_utf8(&encoder, error);
+
+  uv_buf_t buf = uv_buf_init((char *) data, encoder.end);
+
+  uv_fs_t fs;
+  err = uv_fs_write(loop, &fs, req->file, &buf, 1, 0, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  // Drop whatever is left of a longer record written by an earlier bootstrap.
+  if (err >= 0) {
+    err = uv_fs_ftruncate(loop, &fs, req->file, encoder.end, NULL);
+    uv_fs_req_cleanup(&fs);
+  }
+
+  (void) err; // Best effort, waiters fall back to bootstrapping themselves
+
+  req->flushed = uv_hrtime();
+}
+
+static int
+appling_bootstrap__read(appling_bootstrap_t *req, uv_loop_t *loop, uintmax_t *state, uintmax_t *status) {
+  int err;
+
+  uint8_t data[APPLING_BOOTSTRAP_RECORD_MAX];
+
+  uv_buf_t buf = uv_buf_init((char *) data, sizeof(data));
+
+  uv_fs_t fs;
+  err = uv_fs_read(loop, &fs, req->file, &buf, 1, 0, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  if (err < 0) return err;
+
+  compact_state_t decoder = {0, (size_t) err, data};
+
+  uintmax_t downloaded, total;
+
+  err = compact_decode_uint(&decoder, state);
+  if (err < 0) return err;
+
+  err = compact_decode_uint(&decoder, &downloaded);
+  if (err < 0) return err;
+
+  err = compact_decode_uint(&decoder, &total);
+  if (err < 0) return err;
+
+  err = compact_decode_uint(&decoder, status);
+  if (err < 0) return err;
+
+  if (*state == appling_bootstrap__running && total > 0) {
+    appling_bootstrap__host->report(req, downloaded, total);
+  }
+
+  if (*state == appling_bootstrap__failed) {
+    utf8_string_view_t error;
+    err = compact_decode_utf8(&decoder, &error);
+
+    if (err == 0 && error.len > 0) {
+      if (req->error) free(req->error);
+
+      req->error = calloc(error.len + 1 /* NULL */, sizeof(char));
+
+      if (req->error) memcpy(req->error, error.data, error.len);
+    }
+  }
+
+  return 0;
+}
+
+static js_value_t *
+appling_bootstrap__progress(js_env_t *env, js_callback_info_t *info) {
+  int err;
+
+  appling_bootstrap_t *req;
+
+  size_t argc = 2;
+  js_value_t *argv[2];
+
+  err = js_get_callback_info(env, info, &argc, argv, NULL, (void **) &req);
+  assert(err == 0);
+
+  assert(argc == 2);
+
+  int64_t downloaded;
+  err = js_get_value_int64(env, argv[0], &downloaded);
+  assert(err == 0);
+
+  int64_t total;
+  err = js_get_value_int64(env, argv[1], &total);
+  assert(err == 0);
+
+  appling_bootstrap__host->report(req, (uint64_t) downloaded, (uint64_t) total);
+
+  if (uv_hrtime() - req->flushed >= 100000000 /* 100 ms */) {
+    uv_loop_t *loop;
+    err = js_get_env_loop(env, &loop);
+    assert(err == 0);
+
+    appling_bootstrap__write(req, loop, appling_bootstrap__running, 0);
+  }
+
+  return NULL;
+}
+
+static js_value_t *
+appling_bootstrap__connected(js_env_t *env, js_callback_info_t *info) {
+  int err;
+
+  appling_bootstrap_t *req;
+
+  err = js_get_callback_info(env, info, NULL, NULL, NULL, (void **) &req);
+  assert(err == 0);
+
+  if (req->timing.connect == 0) req->timing.connect = uv_hrtime();
+
+  return NULL;
+}
+
+static js_value_t *
+appling_bootstrap__transferred(js_env_t *env, js_callback_info_t *info) {
+  int err;
+
+  appling_bootstrap_t *req;
+
+  size_t argc = 2;
+  js_value_t *argv[2];
+
+  err = js_get_callback_info(env, info, &argc, argv, NULL, (void **) &req);
+  assert(err == 0);
+
+  assert(argc == 2);
+
+  int64_t reused;
+  err = js_get_value_int64(env, argv[0], &reused);
+  assert(err == 0);
+
+  int64_t fetched;
+  err = js_get_value_int64(env, argv[1], &fetched);
+  assert(err == 0);
+
+  req->reused = (uint64_t) reused;
+  req->fetched = (uint64_t) fetched;
+
+  req->timing.transfer = uv_hrtime();
+
+  return NULL;
+}
+
+static js_value_t *
+appling_bootstrap__error(js_env_t *env, js_callback_info_t *info) {
+  int err;
+
+  appling_bootstrap_t *req;
+
+  size_t argc = 1;
+  js_value_t *argv[1];
+
+  err = js_get_callback_info(env, info, &argc, argv, NULL, (void **) &req);
+  assert(err == 0);
+
+  assert(argc == 1);
+
+  size_t len;
+  err = js_get_value_string_utf8(env, argv[0], NULL, 0, &len);
+  assert(err == 0);
+
+  len += 1 /* NULL */;
+
+  req->error = calloc(len, sizeof(char));
+
+  err = js_get_value_string_utf8(env, argv[0], (utf8_t *) req->error, len, NULL);
+  assert(err == 0);
+
+  return NULL;
+}
+
+void
+appling_bootstrap__exports(js_env_t *env, appling_bootstrap_t *req, js_value_t **result) {
+  int err;
+
+  js_value_t *exports;
+  err = js_create_object(env, &exports);
+  assert(err == 0);
+
+  void *buffer;
+
+  js_value_t *key;
+  err = js_create_arraybuffer(env, sizeof(req->key), &buffer, &key);
+  assert(err == 0);
+
+  memcpy(buffer, req->key, sizeof(req->key));
+
+  err = js_set_named_property(env, exports, "key", key);
+  assert(err == 0);
+
+  js_value_t *directory;
+  err = js_create_string_utf8(env, (utf8_t *) req->dir, -1, &directory);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "directory", directory);
+  assert(err == 0);
+
+  js_value_t *nodes;
+  err = js_create_string_utf8(env, (utf8_t *) req->nodes, -1, &nodes);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "nodes", nodes);
+  assert(err == 0);
+
+  js_value_t *error;
+  err = js_create_function(env, "error", -1, appling_bootstrap__error, (void *) req, &error);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "error", error);
+  assert(err == 0);
+
+  js_value_t *progress;
+  err = js_create_function(env, "progress", -1, appling_bootstrap__progress, (void *) req, &progress);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "progress", progress);
+  assert(err == 0);
+
+  js_value_t *connected;
+  err = js_create_function(env, "connected", -1, appling_bootstrap__connected, (void *) req, &connected);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "connected", connected);
+  assert(err == 0);
+
+  js_value_t *transferred;
+  err = js_create_function(env, "transferred", -1, appling_bootstrap__transferred, (void *) req, &transferred);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "transferred", transferred);
+  assert(err == 0);
+
+  *result = exports;
+}
+
+static void
+appling_bootstrap__run(appling_bootstrap_t *req, uv_loop_t *loop) {
+  int err;
+
+  js_env_t *env;
+
+  bare_options_t options = {
+    .version = 0,
+    .memory_limit = req->memory_limit,
+  };
+
+  bare_t *bare;
+  err = bare_setup(loop, appling_runtime__platform(), &env, 0, NULL, &options, &bare);
+  assert(err == 0);
+
+  req->timing.setup = uv_hrtime();
+
+  js_handle_scope_t *scope;
+  err = js_open_handle_scope(env, &scope);
+  assert(err == 0);
+
+  js_value_t *global;
+  err = js_get_global(env, &global);
+  assert(err == 0);
+
+  js_value_t *exports;
+  appling_bootstrap__exports(env, req, &exports);
+
+  err = js_set_named_property(env, global, "Appling", exports);
+  assert(err == 0);
+
+  err = js_close_handle_scope(env, scope);
+  assert(err == 0);
+
+#if defined(APPLING_COMPRESSED_BUNDLE)
+  // The bundle is only decompressed once a bootstrap actually happens and is
+  // kept around until the runtime has been torn down.
+  size_t len = bootstrap_bundle_len;
+
+  uint8_t *bundle = malloc(len);
+  assert(bundle);
+
+  err = appling_lz4__decompress(bootstrap_bundle_compressed, bootstrap_bundle_compressed_len, bundle, &len);
+  assert(err == 0 && len == bootstrap_bundle_len);
+
+  uv_buf_t source = uv_buf_init((char *) bundle, len);
+#else
+  uv_buf_t source = uv_buf_init((char *) bootstrap_bundle, bootstrap_bundle_len);
+#endif
+
+  // The bundle is compiled from source on every bootstrap, as `bare_load()`
+  // takes no code cache to compile it from. Its cost shows up as the time from
+  // `timing.setup` to `timing.load`, and the time to the first connection as
+  // that from `timing.start` to `timing.connect`.
+  err = bare_load(bare, "bare:/appling.bundle", &source, NULL);
+  assert(err == 0);
+
+  req->timing.load = uv_hrtime();
+
+  err = bare_run(bare, UV_RUN_DEFAULT);
+  assert(err == 0);
+
+  req->timing.run = uv_hrtime();
+
+  err = bare_teardown(bare, UV_RUN_DEFAULT, &req->status);
+  assert(err == 0);
+
+  req->timing.teardown = uv_hrtime();
+
+#if defined(APPLING_COMPRESSED_BUNDLE)
+  free(bundle);
+#endif
+}
+
+static int
+appling_bootstrap__storage(appling_bootstrap_t *req, uv_loop_t *loop) {
+  int err;
+
+  // The platform storage is always opened from the platform directory, so a
+  // storage location chosen by the caller is linked into place. Storage left
+  // behind in the platform directory by an earlier bootstrap is moved rather
+  // than discarded so that none of its blocks have to be fetched again, as is
+  // storage at a location that the caller has since moved away from. Should
+  // there be storage at both places, neither is discarded and UV_EEXIST is
+  // returned for the caller to resolve.
+
+  appling_path_t path;
+  size_t path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {req->dir, "corestores", "platform", NULL},
+    path,
+    &path_len,
+    path_behavior_system
+  );
+
+  uv_stat_t stat;
+  err = appling_fs__lstat(loop, path, &stat);
+
+  if (err == 0 && appling_fs__is_link(&stat)) {
+    appling_path_t previous = {'\0'};
+
+    uv_fs_t fs;
+    err = uv_fs_readlink(loop, &fs, path, NULL);
+
+    if (err == 0) strncpy(previous, (const char *) fs.ptr, sizeof(previous) - 1);
+
+    uv_fs_req_cleanup(&fs);
+
+    if (strcmp(previous, req->storage) == 0) return 0;
+
+    err = uv_fs_unlink(loop, &fs, path, NULL);
+    uv_fs_req_cleanup(&fs);
+
+    if (err < 0) return err;
+
+    uv_stat_t target;
+    err = appling_fs__lstat(loop, req->storage, &target);
+
+    if (err == UV_ENOENT && previous[0]) appling_fs__rename(loop, previous, req->storage);
+  } else if (err == 0) {
+    uv_stat_t target;
+    err = appling_fs__lstat(loop, req->storage, &target);
+
+    if (err == 0) return UV_EEXIST;
+
+    err = appling_fs__rename(loop, path, req->storage);
+    if (err < 0) return err;
+  } else if (err != UV_ENOENT) {
+    return err;
+  }
+
+  err = appling_fs__mkdir(loop, req->storage);
+  if (err < 0) return err;
+
+  path_len = sizeof(appling_path_t);
+
+  appling_path_t corestores;
+
+  path_join(
+    (const char *[]) {req->dir, "corestores", NULL},
+    corestores,
+    &path_len,
+    path_behavior_system
+  );
+
+  err = appling_fs__mkdir(loop, corestores);
+  if (err < 0) return err;
+
+  return appling_fs__symlink(loop, req->storage, path);
+}
+
+static void
+appling_bootstrap__fail(appling_bootstrap_t *req, int err) {
+  const char *message = uv_strerror(err);
+
+  req->error = calloc(strlen(message) + 1 /* NULL */, sizeof(char));
+
+  strcpy(req->error, message);
+
+  req->status = 1;
+}
+
+static void
+appling_bootstrap__seed(appling_bootstrap_t *req, uv_loop_t *loop) {
+  int err;
+
+  err = appling_seed__install(loop, req->seed, req->dir, req->key, req->length);
+
+  if (err < 0) appling_bootstrap__fail(req, err);
+  else req->status = 0;
+}
+
+// Resource usage isn't tracked per thread, so this is the peak of the whole
+// process rather than of the bootstrap alone.
+static size_t
+appling_bootstrap__peak_rss(void) {
+  int err;
+
+  uv_rusage_t usage;
+  err = uv_getrusage(&usage);
+  if (err < 0) return 0;
+
+#if defined(APPLING_OS_DARWIN)
+  return (size_t) usage.ru_maxrss; // Reported in bytes
+#else
+  return (size_t) usage.ru_maxrss * 1024; // Reported in kilobytes
+#endif
+}
+
+static void
+appling_bootstrap__on_thread(void *data) {
+  int err;
+
+  appling_bootstrap_t *req = (appling_bootstrap_t *) data;
+
+  req->timing.thread = uv_hrtime();
+
+  uv_loop_t loop;
+  err = uv_loop_init(&loop);
+  assert(err == 0);
+
+  // Only a single process bootstraps a given platform directory at a time,
+  // coordinated through an exclusive lock on a shared state file. Processes
+  // that arrive while a bootstrap is in progress wait for the lock to be
+  // released, reporting the progress of the leader in the meantime, and then
+  // adopt its result rather than downloading the platform again.
+
+  appling_path_t path;
+  size_t path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {req->dir, "bootstrap", NULL},
+    path,
+    &path_len,
+    path_behavior_system
+  );
+
+  err = appling_fs__mkdir(&loop, req->dir);
+
+  if (err == 0) {
+    uv_fs_t fs;
+    err = uv_fs_open(&loop, &fs, path, UV_FS_O_RDWR | UV_FS_O_CREAT, 0666, NULL);
+    uv_fs_req_cleanup(&fs);
+  }
+
+  req->file = err < 0 ? -1 : err;
+
+  bool waited = false;
+
+  if (req->file >= 0) {
+    uintmax_t state, status;
+
+    while ((err = appling_bootstrap__try_lock(req->file)) == UV_EAGAIN) {
+      waited = true;
+
+      appling_bootstrap__read(req, &loop, &state, &status);
+
+      uv_sleep(250);
+    }
+
+    if (err < 0) {
+      uv_fs_t fs;
+      uv_fs_close(&loop, &fs, req->file, NULL);
+      uv_fs_req_cleanup(&fs);
+
+      req->file = -1; // Locking unsupported, bootstrap uncoordinated
+    }
+  }
+
+  req->timing.lock = uv_hrtime();
+
+  uintmax_t state = appling_bootstrap__running, status = 0;
+
+  if (req->file >= 0 && waited) {
+    err = appling_bootstrap__read(req, &loop, &state, &status);
+
+    if (err < 0) state = appling_bootstrap__running;
+  }
+
+  // Only the error of a failed leader is adopted, not one read from an earlier
+  // record while waiting.
+  if (state != appling_bootstrap__failed && req->error) {
+    free(req->error);
+
+    req->error = NULL;
+  }
+
+  if (state == appling_bootstrap__running) {
+    appling_bootstrap__write(req, &loop, appling_bootstrap__running, 0);
+
+    err = 0;
+
+    if (req->storage[0] && !req->seed[0]) {
+      err = appling_bootstrap__storage(req, &loop);
+
+      // Storage at both places is left alone rather than discarding either,
+      // so the bootstrap fails until the caller has resolved the conflict.
+      if (err == UV_EEXIST) {
+        log_debug("appling_bootstrap() found storage both in %s and at %s", req->dir, req->storage);
+
+        appling_bootstrap__fail(req, err);
+      } else if (err < 0) {
+        log_debug("appling_bootstrap() could not link storage: %s", uv_strerror(err));
+
+        err = 0;
+      }
+    }
+
+    if (err == 0) {
+      if (req->seed[0]) appling_bootstrap__seed(req, &loop);
+      else if (req->shared) appling_bootstrap__worker_run(req);
+      else appling_bootstrap__run(req, &loop);
+    }
+
+    if (req->status == 0 && req->dedupe) {
+      err = appling_dedupe__run(&loop, req->dir, &req->deduped);
+
+      if (err < 0) log_debug("appling_bootstrap() could not deduplicate platform: %s", uv_strerror(err));
+    }
+
+    appling_bootstrap__write(req, &loop, req->status == 0 ? appling_bootstrap__succeeded : appling_bootstrap__failed, req->status);
+  } else {
+    req->status = (int) status; // Adopt the result of the leader
+  }
+
+  if (req->file >= 0) {
+    uv_fs_t fs;
+    uv_fs_close(&loop, &fs, req->file, NULL);
+    uv_fs_req_cleanup(&fs);
+  }
+
+  err = uv_loop_close(&loop);
+  assert(err == 0);
+
+  req->peak_rss = appling_bootstrap__peak_rss();
+
+  req->timing.end = uv_hrtime();
+
+  appling_bootstrap__host->done(req);
+}
+
+int
+appling_bootstrap_v0(appling_bootstrap_t *req, const appling_bootstrap_host_t *host) {
+  appling_bootstrap__host = host;
+
+  uv_thread_options_t options = {
+    .flags = req->stack_size ? UV_THREAD_HAS_STACK_SIZE : UV_THREAD_NO_FLAGS,
+    .stack_size = req->stack_size,
+  };
+
+  return uv_thread_create_ex(&req->thread, &options, appling_bootstrap__on_thread, (void *) req);
+}
@@ -0,0 +1,26 @@
+#ifndef APPLING_BOOTSTRAP_RUNTIME_H
+#define APPLING_BOOTSTRAP_RUNTIME_H
+
+#include <stdint.h>
+
+#include "../include/appling.h"
+
+// The bootstrap runtime, comprising bare, its addons, and the bootstrap bundle,
+// is built as a separate module that is only loaded once a bootstrap is
+// actually needed. The module carries its own copy of its dependencies and so
+// reports back through functions provided by the caller rather than touching
+// handles on the caller loop itself.
+
+typedef struct appling_bootstrap_host_s appling_bootstrap_host_t;
+
+typedef int (*appling_bootstrap_runtime_cb)(appling_bootstrap_t *req, const appling_bootstrap_host_t *host);
+
+struct appling_bootstrap_host_s {
+  void (*report)(appling_bootstrap_t *req, uint64_t downloaded, uint64_t total);
+  void (*done)(appling_bootstrap_t *req);
+};
+
+int
+appling_bootstrap_v0(appling_bootstrap_t *req, const appling_bootstrap_host_t *host);
+
+#endif // APPLING_BOOTSTRAP_RUNTIME_H
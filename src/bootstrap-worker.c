@@ -0,0 +1,258 @@
+#include <assert.h>
+#include <bare.h>
+#include <js.h>
+#include <log.h>
+#include <stdlib.h>
+#include <utf.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#include "bootstrap-worker.h"
+#include "bootstrap-worker.bundle.h"
+#include "runtime.h"
+
+typedef struct appling_bootstrap__job_s appling_bootstrap__job_t;
+
+struct appling_bootstrap__job_s {
+  appling_bootstrap_t *req;
+
+  uv_sem_t finished;
+
+  appling_bootstrap__job_t *next;
+};
+
+static uv_once_t appling_bootstrap__worker_guard = UV_ONCE_INIT;
+
+static struct {
+  uv_thread_t thread;
+  uv_loop_t loop;
+  uv_async_t wakeup;
+  uv_mutex_t lock;
+
+  js_env_t *env;
+
+  appling_bootstrap__job_t *head;
+  appling_bootstrap__job_t *tail;
+} appling_bootstrap__worker;
+
+static js_value_t *
+appling_bootstrap__worker_done(js_env_t *env, js_callback_info_t *info) {
+  int err;
+
+  appling_bootstrap__job_t *job;
+
+  size_t argc = 1;
+  js_value_t *argv[1];
+
+  err = js_get_callback_info(env, info, &argc, argv, NULL, (void **) &job);
+  assert(err == 0);
+
+  assert(argc == 1);
+
+  int32_t status;
+  err = js_get_value_int32(env, argv[0], &status);
+  assert(err == 0);
+
+  appling_bootstrap_t *req = job->req;
+
+  req->status = status;
+  req->timing.run = uv_hrtime();
+
+  uv_sem_post(&job->finished); // The job is gone once posted
+
+  return NULL;
+}
+
+static js_value_t *
+appling_bootstrap__worker_error(js_env_t *env, js_callback_info_t *info) {
+  int err;
+
+  size_t argc = 1;
+  js_value_t *argv[1];
+
+  err = js_get_callback_info(env, info, &argc, argv, NULL, NULL);
+  assert(err == 0);
+
+  assert(argc == 1);
+
+  utf8_t error[1024];
+  err = js_get_value_string_utf8(env, argv[0], error, sizeof(error), NULL);
+  assert(err == 0);
+
+  log_debug("appling_bootstrap() shared worker failed: %s", (char *) error);
+
+  return NULL;
+}
+
+static void
+appling_bootstrap__worker_dispatch(appling_bootstrap__job_t *job) {
+  int err;
+
+  js_env_t *env = appling_bootstrap__worker.env;
+
+  appling_bootstrap_t *req = job->req;
+
+  req->timing.setup = req->timing.load = uv_hrtime();
+
+  js_handle_scope_t *scope;
+  err = js_open_handle_scope(env, &scope);
+  assert(err == 0);
+
+  js_value_t *exports;
+  appling_bootstrap__exports(env, req, &exports);
+
+  js_value_t *done;
+  err = js_create_function(env, "done", -1, appling_bootstrap__worker_done, (void *) job, &done);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "done", done);
+  assert(err == 0);
+
+  js_value_t *global;
+  err = js_get_global(env, &global);
+  assert(err == 0);
+
+  js_value_t *appling;
+  err = js_get_named_property(env, global, "Appling", &appling);
+  assert(err == 0);
+
+  js_value_t *fn;
+  err = js_get_named_property(env, appling, "onjob", &fn);
+  assert(err == 0);
+
+  err = js_call_function(env, appling, fn, 1, (js_value_t *[]) {exports}, NULL);
+
+  if (err < 0) {
+    js_value_t *error;
+    err = js_get_and_clear_last_exception(env, &error);
+    assert(err == 0);
+
+    req->status = 1;
+
+    uv_sem_post(&job->finished);
+  }
+
+  err = js_close_handle_scope(env, scope);
+  assert(err == 0);
+}
+
+static void
+appling_bootstrap__worker_on_wakeup(uv_async_t *handle) {
+  if (appling_bootstrap__worker.env == NULL) return; // Not yet loaded, woken up again once it is
+
+  uv_mutex_lock(&appling_bootstrap__worker.lock);
+
+  appling_bootstrap__job_t *job = appling_bootstrap__worker.head;
+
+  appling_bootstrap__worker.head = appling_bootstrap__worker.tail = NULL;
+
+  uv_mutex_unlock(&appling_bootstrap__worker.lock);
+
+  while (job) {
+    appling_bootstrap__job_t *next = job->next;
+
+    appling_bootstrap__worker_dispatch(job);
+
+    job = next;
+  }
+}
+
+static void
+appling_bootstrap__worker_on_thread(void *data) {
+  int err;
+
+  js_env_t *env;
+
+  bare_t *bare;
+  err = bare_setup(&appling_bootstrap__worker.loop, appling_runtime__platform(), &env, 0, NULL, NULL, &bare);
+  assert(err == 0);
+
+  js_handle_scope_t *scope;
+  err = js_open_handle_scope(env, &scope);
+  assert(err == 0);
+
+  js_value_t *global;
+  err = js_get_global(env, &global);
+  assert(err == 0);
+
+  js_value_t *exports;
+  err = js_create_object(env, &exports);
+  assert(err == 0);
+
+  err = js_set_named_property(env, global, "Appling", exports);
+  assert(err == 0);
+
+  js_value_t *error;
+  err = js_create_function(env, "error", -1, appling_bootstrap__worker_error, NULL, &error);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "error", error);
+  assert(err == 0);
+
+  err = js_close_handle_scope(env, scope);
+  assert(err == 0);
+
+  uv_buf_t source = uv_buf_init((char *) bootstrap_worker_bundle, bootstrap_worker_bundle_len);
+
+  err = bare_load(bare, "bare:/bootstrap-worker.bundle", &source, NULL);
+  assert(err == 0);
+
+  appling_bootstrap__worker.env = env;
+
+  err = uv_async_send(&appling_bootstrap__worker.wakeup); // Dispatch jobs queued while loading
+  assert(err == 0);
+
+  // The wakeup handle is never closed, so the worker runs for the remainder of
+  // the process. The swarm and stores are released whenever it goes idle.
+  err = bare_run(bare, UV_RUN_DEFAULT);
+  assert(err == 0);
+}
+
+static void
+appling_bootstrap__worker_on_init(void) {
+  int err;
+
+  err = uv_loop_init(&appling_bootstrap__worker.loop);
+  assert(err == 0);
+
+  err = uv_mutex_init(&appling_bootstrap__worker.lock);
+  assert(err == 0);
+
+  err = uv_async_init(&appling_bootstrap__worker.loop, &appling_bootstrap__worker.wakeup, appling_bootstrap__worker_on_wakeup);
+  assert(err == 0);
+
+  err = uv_thread_create(&appling_bootstrap__worker.thread, appling_bootstrap__worker_on_thread, NULL);
+  assert(err == 0);
+}
+
+void
+appling_bootstrap__worker_run(appling_bootstrap_t *req) {
+  int err;
+
+  uv_once(&appling_bootstrap__worker_guard, appling_bootstrap__worker_on_init);
+
+  appling_bootstrap__job_t job = {
+    .req = req,
+    .next = NULL,
+  };
+
+  err = uv_sem_init(&job.finished, 0);
+  assert(err == 0);
+
+  uv_mutex_lock(&appling_bootstrap__worker.lock);
+
+  if (appling_bootstrap__worker.tail) appling_bootstrap__worker.tail->next = &job;
+  else appling_bootstrap__worker.head = &job;
+
+  appling_bootstrap__worker.tail = &job;
+
+  uv_mutex_unlock(&appling_bootstrap__worker.lock);
+
+  err = uv_async_send(&appling_bootstrap__worker.wakeup);
+  assert(err == 0);
+
+  uv_sem_wait(&job.finished);
+
+  uv_sem_destroy(&job.finished);
+}
@@ -0,0 +1,20 @@
+#ifndef APPLING_BOOTSTRAP_WORKER_H
+#define APPLING_BOOTSTRAP_WORKER_H
+
+#include <js.h>
+
+#include "../include/appling.h"
+
+// Bootstraps that set the `shared` option are run on a single worker that
+// holds one bare environment, one swarm, and one store per platform directory
+// for all of them. The bootstrap thread of each request still coordinates with
+// other processes as usual, but then hands the download itself off to the
+// worker and waits for it to finish.
+
+void
+appling_bootstrap__exports(js_env_t *env, appling_bootstrap_t *req, js_value_t **result);
+
+void
+appling_bootstrap__worker_run(appling_bootstrap_t *req);
+
+#endif // APPLING_BOOTSTRAP_WORKER_H
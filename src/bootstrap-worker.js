@@ -0,0 +1,159 @@
+const Corestore = require('corestore')
+const Hyperswarm = require('hyperswarm')
+const path = require('bare-path')
+const bootstrap = require('pear-updater-bootstrap')
+
+const onerror = (err) => {
+  Appling.error(err.stack)
+}
+
+Bare.on('uncaughtException', onerror).on('unhandledRejection', onerror)
+
+// All jobs share a single swarm per set of DHT bootstrap nodes, which is just
+// the one for the public network unless jobs ask for a testnet, and jobs for
+// the same platform directory share a single store. Both are released once no
+// jobs are running.
+const swarms = new Map()
+
+const stores = new Map()
+
+let active = 0
+
+function connect(nodes) {
+  let swarm = swarms.get(nodes)
+
+  if (swarm) return swarm
+
+  const opts = {}
+
+  if (nodes) {
+    opts.bootstrap = nodes.split(',').map((node) => {
+      const i = node.lastIndexOf(':')
+
+      return { host: node.slice(0, i), port: Number(node.slice(i + 1)) }
+    })
+  }
+
+  swarm = new Hyperswarm(opts)
+
+  swarm.on('connection', (connection) => {
+    for (const { store } of stores.values()) store.replicate(connection)
+  })
+
+  swarms.set(nodes, swarm)
+
+  return swarm
+}
+
+function open(directory) {
+  let entry = stores.get(directory)
+
+  if (entry === undefined) {
+    const store = new Corestore(path.join(directory, 'corestores', 'platform'))
+
+    for (const swarm of swarms.values()) {
+      for (const connection of swarm.connections) store.replicate(connection)
+    }
+
+    entry = { store, refs: 0 }
+
+    stores.set(directory, entry)
+  }
+
+  entry.refs++
+
+  return entry.store
+}
+
+async function close(directory) {
+  const entry = stores.get(directory)
+
+  if (--entry.refs > 0) return
+
+  stores.delete(directory)
+
+  await entry.store.close()
+}
+
+async function run(job) {
+  let downloaded = 0
+  let fetched = 0
+  let platform = null
+
+  const ondownload = (index, byteLength) => {
+    fetched += byteLength
+  }
+
+  const onupdater = (updater) => {
+    const drive = updater.drive
+
+    if (!drive) return
+
+    if (drive.core) {
+      drive.core.once('peer-add', () => job.connected())
+      drive.core.on('download', ondownload)
+    }
+
+    drive.getBlobs().then((blobs) => {
+      if (!blobs) return
+
+      platform = blobs.core
+
+      blobs.core.on('download', (index, byteLength) => {
+        downloaded += byteLength
+
+        ondownload(index, byteLength)
+
+        job.progress(downloaded, blobs.core.byteLength)
+      })
+    }, onerror)
+  }
+
+  const opts = {
+    lock: false,
+    swarm: connect(job.nodes),
+    corestore: open(job.directory),
+    onupdater
+  }
+
+  try {
+    await bootstrap(Buffer.from(job.key), job.directory, opts)
+  } finally {
+    await close(job.directory)
+  }
+
+  const total = platform ? platform.byteLength : 0
+
+  job.transferred(Math.max(total - downloaded, 0), fetched)
+}
+
+async function release() {
+  if (active > 0) return
+
+  const idle = [...swarms.values()]
+
+  swarms.clear()
+
+  await Promise.all(idle.map((swarm) => swarm.destroy()))
+}
+
+Appling.onjob = (job) => {
+  active++
+
+  run(job)
+    .then(
+      () => 0,
+      (err) => {
+        job.error(err.stack)
+
+        return 1
+      }
+    )
+    .then(async (status) => {
+      active--
+
+      await release().catch(onerror)
+
+      job.done(status)
+    })
+}
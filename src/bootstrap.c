@@ -1,126 +1,59 @@
 #include <assert.h>
-#include <bare.h>
-#include <js.h>
 #include <path.h>
+#include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <utf.h>
 #include <uv.h>
 
 #include "../include/appling.h"
 
+#include "bootstrap-process.h"
+#include "bootstrap-runtime.h"
+#include "module.h"
 #include "platform-dir.h"
-#include "bootstrap.bundle.h"
 
-static js_value_t *
-appling_bootstrap__error(js_env_t *env, js_callback_info_t *info) {
+static void
+appling_bootstrap__on_report(appling_bootstrap_t *req, uint64_t downloaded, uint64_t total) {
   int err;
 
-  appling_bootstrap_t *req;
-
-  size_t argc = 1;
-  js_value_t *argv[1];
-
-  err = js_get_callback_info(env, info, &argc, argv, NULL, (void **) &req);
-  assert(err == 0);
-
-  assert(argc == 1);
+  uv_mutex_lock(&req->lock);
 
-  size_t len;
-  err = js_get_value_string_utf8(env, argv[0], NULL, 0, &len);
-  assert(err == 0);
+  req->downloaded = downloaded;
+  req->total = total;
+  req->pending = true;
 
-  len += 1 /* NULL */;
+  uv_mutex_unlock(&req->lock);
 
-  req->error = calloc(len, sizeof(char));
-
-  err = js_get_value_string_utf8(env, argv[0], (utf8_t *) req->error, len, NULL);
+  err = uv_async_send(&req->signal);
   assert(err == 0);
-
-  return NULL;
 }
 
 static void
-appling_bootstrap__on_thread(void *data) {
+appling_bootstrap__on_done(appling_bootstrap_t *req) {
   int err;
 
-  appling_bootstrap_t *req = (appling_bootstrap_t *) data;
-
-  uv_loop_t loop;
-  err = uv_loop_init(&loop);
-  assert(err == 0);
-
-  js_env_t *env;
-
-  bare_t *bare;
-  err = bare_setup(&loop, req->js, &env, 0, NULL, NULL, &bare);
-  assert(err == 0);
-
-  js_handle_scope_t *scope;
-  err = js_open_handle_scope(env, &scope);
-  assert(err == 0);
-
-  js_value_t *global;
-  err = js_get_global(env, &global);
-  assert(err == 0);
-
-  js_value_t *exports;
-  err = js_create_object(env, &exports);
-  assert(err == 0);
-
-  err = js_set_named_property(env, global, "Appling", exports);
-  assert(err == 0);
-
-  void *buffer;
-
-  js_value_t *key;
-  err = js_create_arraybuffer(env, sizeof(req->key), &buffer, &key);
-  assert(err == 0);
-
-  memcpy(buffer, req->key, sizeof(req->key));
-
-  err = js_set_named_property(env, exports, "key", key);
-  assert(err == 0);
-
-  js_value_t *directory;
-  err = js_create_string_utf8(env, (utf8_t *) req->dir, -1, &directory);
-  assert(err == 0);
-
-  err = js_set_named_property(env, exports, "directory", directory);
-  assert(err == 0);
-
-  js_value_t *error;
-  err = js_create_function(env, "error", -1, appling_bootstrap__error, (void *) req, &error);
-  assert(err == 0);
-
-  err = js_set_named_property(env, exports, "error", error);
-  assert(err == 0);
-
-  err = js_close_handle_scope(env, scope);
-  assert(err == 0);
-
-  uv_buf_t source = uv_buf_init((char *) bootstrap_bundle, bootstrap_bundle_len);
-
-  err = bare_load(bare, "bare:/appling.bundle", &source, NULL);
-  assert(err == 0);
-
-  err = bare_run(bare, UV_RUN_DEFAULT);
-  assert(err == 0);
+  uv_mutex_lock(&req->lock);
 
-  err = bare_teardown(bare, UV_RUN_DEFAULT, &req->status);
-  assert(err == 0);
+  req->done = true;
 
-  err = uv_loop_close(&loop);
-  assert(err == 0);
+  uv_mutex_unlock(&req->lock);
 
   err = uv_async_send(&req->signal);
   assert(err == 0);
 }
 
+static const appling_bootstrap_host_t appling_bootstrap__host = {
+  .report = appling_bootstrap__on_report,
+  .done = appling_bootstrap__on_done,
+};
+
 static void
 appling_bootstrap__on_close(uv_handle_t *handle) {
   appling_bootstrap_t *req = (appling_bootstrap_t *) handle->data;
 
+  uv_mutex_destroy(&req->lock);
+
   if (req->cb) req->cb(req, req->status);
 
   if (req->error) free(req->error);
@@ -128,22 +61,139 @@ appling_bootstrap__on_close(uv_handle_t *handle) {
 
 static void
 appling_bootstrap__on_signal(uv_async_t *handle) {
-  uv_close((uv_handle_t *) handle, appling_bootstrap__on_close);
+  appling_bootstrap_t *req = (appling_bootstrap_t *) handle->data;
+
+  uv_mutex_lock(&req->lock);
+
+  bool pending = req->pending;
+  bool done = req->done;
+
+  uint64_t downloaded = req->downloaded;
+  uint64_t total = req->total;
+
+  req->pending = false;
+
+  uv_mutex_unlock(&req->lock);
+
+  if (pending && req->progress) req->progress(downloaded, total);
+
+  if (done) uv_close((uv_handle_t *) handle, appling_bootstrap__on_close);
 }
 
 int
-appling_bootstrap(uv_loop_t *loop, js_platform_t *js, appling_bootstrap_t *req, const appling_key_t key, const char *dir, appling_bootstrap_cb cb) {
+appling_bootstrap(uv_loop_t *loop, appling_bootstrap_t *req, const appling_key_t key, const char *dir, const appling_bootstrap_options_t *options, appling_bootstrap_cb cb) {
   int err;
 
   req->loop = loop;
-  req->js = js;
   req->cb = cb;
+  req->progress = NULL;
+  req->memory_limit = 0;
+  req->stack_size = 0;
+  req->shared = false;
+  req->dedupe = false;
+  req->peak_rss = 0;
+  req->reused = 0;
+  req->fetched = 0;
+  req->deduped = 0;
+  memset(&req->timing, 0, sizeof(req->timing));
+
+  req->timing.start = uv_hrtime();
+  req->file = -1;
+  req->downloaded = 0;
+  req->total = 0;
+  req->flushed = 0;
+  req->pending = false;
+  req->done = false;
   req->status = 0;
   req->error = NULL;
   req->signal.data = (void *) req;
 
-  err = uv_async_init(loop, &req->signal, appling_bootstrap__on_signal);
-  if (err < 0) return err;
+  req->seed[0] = '\0';
+  req->module[0] = '\0';
+  req->storage[0] = '\0';
+  req->nodes[0] = '\0';
+  req->executable[0] = '\0';
+  req->length = 0;
+  req->buffer = NULL;
+  req->buffer_len = 0;
+  req->handles = 0;
+
+  if (options) {
+    req->progress = options->progress;
+    req->length = options->length;
+    req->memory_limit = options->memory_limit;
+    req->stack_size = options->stack_size;
+    req->shared = options->shared;
+    req->dedupe = options->dedupe;
+
+    if (options->seed && path_is_absolute(options->seed, path_behavior_system)) strcpy(req->seed, options->seed);
+    else if (options->seed) {
+      appling_path_t cwd;
+      size_t path_len = sizeof(appling_path_t);
+
+      err = uv_cwd(cwd, &path_len);
+      if (err < 0) return err;
+
+      path_len = sizeof(appling_path_t);
+
+      path_join(
+        (const char *[]) {cwd, options->seed, NULL},
+        req->seed,
+        &path_len,
+        path_behavior_system
+      );
+    }
+
+    if (options->module && path_is_absolute(options->module, path_behavior_system)) strcpy(req->module, options->module);
+    else if (options->module) {
+      appling_path_t cwd;
+      size_t path_len = sizeof(appling_path_t);
+
+      err = uv_cwd(cwd, &path_len);
+      if (err < 0) return err;
+
+      path_len = sizeof(appling_path_t);
+
+      path_join(
+        (const char *[]) {cwd, options->module, NULL},
+        req->module,
+        &path_len,
+        path_behavior_system
+      );
+    }
+
+    if (options->storage && path_is_absolute(options->storage, path_behavior_system)) strcpy(req->storage, options->storage);
+    else if (options->storage) {
+      appling_path_t cwd;
+      size_t path_len = sizeof(appling_path_t);
+
+      err = uv_cwd(cwd, &path_len);
+      if (err < 0) return err;
+
+      path_len = sizeof(appling_path_t);
+
+      path_join(
+        (const char *[]) {cwd, options->storage, NULL},
+        req->storage,
+        &path_len,
+        path_behavior_system
+      );
+    }
+
+    if (options->nodes) {
+      if (strlen(options->nodes) > APPLING_NODES_MAX) return UV_EINVAL;
+
+      strcpy(req->nodes, options->nodes);
+    }
+
+    if (options->spawn && options->executable) strcpy(req->executable, options->executable);
+    else if (options->spawn) {
+      size_t path_len = sizeof(appling_path_t);
+
+      err = uv_exepath(req->executable, &path_len);
+      if (err < 0) return err;
+    }
+  }
 
   memcpy(req->key, key, sizeof(appling_key_t));
 
@@ -180,5 +230,78 @@ appling_bootstrap(uv_loop_t *loop, js_platform_t *js, appling_bootstrap_t *req,
     );
   }
 
-  return uv_thread_create(&req->thread, appling_bootstrap__on_thread, (void *) req);
+  if (req->executable[0]) return appling_bootstrap__spawn(req);
+
+  appling_bootstrap_runtime_cb runtime;
+  err = appling_module__load(req->module[0] ? req->module : NULL, "appling_bootstrap_v0", (void **) &runtime);
+  if (err < 0) return err;
+
+  err = uv_mutex_init(&req->lock);
+  if (err < 0) return err;
+
+  err = uv_async_init(loop, &req->signal, appling_bootstrap__on_signal);
+  if (err < 0) {
+    uv_mutex_destroy(&req->lock);
+
+    return err;
+  }
+
+  err = runtime(req, &appling_bootstrap__host);
+  if (err < 0) {
+    uv_close((uv_handle_t *) &req->signal, NULL);
+
+    uv_mutex_destroy(&req->lock);
+  }
+
+  return err;
+}
+
+int
+appling_bootstrap_format_timing(const appling_bootstrap_timing_t *timing, char *buf, size_t *len) {
+  struct {
+    const char *name;
+    uint64_t time;
+  } phases[] = {
+    {"thread", timing->thread},
+    {"lock", timing->lock},
+    {"setup", timing->setup},
+    {"load", timing->load},
+    {"connect", timing->connect},
+    {"transfer", timing->transfer},
+    {"run", timing->run},
+    {"teardown", timing->teardown},
+  };
+
+  size_t size = *len, written = 0;
+
+  // Each phase is measured from the last phase that was reached before it.
+  uint64_t previous = timing->start;
+
+  for (size_t i = 0, n = sizeof(phases) / sizeof(phases[0]); i <= n; i++) {
+    const char *name = i < n ? phases[i].name : "total";
+
+    uint64_t from = i < n ? previous : timing->start;
+    uint64_t to = i < n ? phases[i].time : timing->end;
+
+    char *at = written < size ? buf + written : NULL;
+    size_t available = written < size ? size - written : 0;
+
+    int res;
+
+    if (to == 0 || from == 0) {
+      res = snprintf(at, available, "%s%s=-", i ? " " : "", name);
+    } else {
+      res = snprintf(at, available, "%s%s=%.1fms", i ? " " : "", name, (to - from) / 1e6);
+
+      previous = to;
+    }
+
+    if (res < 0) return UV_EINVAL;
+
+    written += (size_t) res;
+  }
+
+  *len = written;
+
+  return written < size ? 0 : UV_ENOBUFS;
 }
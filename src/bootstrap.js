@@ -6,6 +6,84 @@ const onerror = (err) => {
 
 Bare.on('uncaughtException', onerror).on('unhandledRejection', onerror)
 
-require('pear-updater-bootstrap')(Buffer.from(Appling.key), Appling.directory, {
-  lock: false
+let downloaded = 0
+let fetched = 0
+let platform = null
+
+function ondownload(index, byteLength) {
+  fetched += byteLength
+}
+
+function onupdater(updater) {
+  const drive = updater.drive
+
+  if (!drive) return
+
+  if (drive.core) {
+    drive.core.once('peer-add', () => Appling.connected())
+    drive.core.on('download', ondownload)
+  }
+
+  drive.getBlobs().then((blobs) => {
+    if (!blobs) return
+
+    platform = blobs.core
+
+    blobs.core.on('download', (index, byteLength) => {
+      downloaded += byteLength
+
+      ondownload(index, byteLength)
+
+      Appling.progress(downloaded, blobs.core.byteLength)
+    })
+  }, onerror)
+}
+
+const opts = {
+  lock: false,
+  onupdater
+}
+
+// When given DHT bootstrap nodes, such as those of a local testnet, the swarm
+// and store are set up here rather than by pear-updater-bootstrap.
+let swarm = null
+
+if (Appling.nodes) {
+  const Corestore = require('corestore')
+  const Hyperswarm = require('hyperswarm')
+  const path = require('bare-path')
+
+  const bootstrap = Appling.nodes.split(',').map((node) => {
+    const i = node.lastIndexOf(':')
+
+    return { host: node.slice(0, i), port: Number(node.slice(i + 1)) }
+  })
+
+  const store = new Corestore(
+    path.join(Appling.directory, 'corestores', 'platform')
+  )
+
+  swarm = new Hyperswarm({ bootstrap })
+
+  swarm.on('connection', (connection) => store.replicate(connection))
+
+  opts.swarm = swarm
+  opts.corestore = store
+}
+
+// Blocks already in storage are never downloaded again, so whatever part of
+// the platform was not fetched by this bootstrap was reused.
+require('pear-updater-bootstrap')(
+  Buffer.from(Appling.key),
+  Appling.directory,
+  opts
+).then(async () => {
+  const total = platform ? platform.byteLength : 0
+
+  Appling.transferred(Math.max(total - downloaded, 0), fetched)
+
+  if (swarm) {
+    await swarm.destroy()
+    await opts.corestore.close()
+  }
 })
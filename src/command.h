@@ -0,0 +1,116 @@
+#ifndef APPLING_COMMAND_H
+#define APPLING_COMMAND_H
+
+#include <path.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/appling.h"
+
+// The command lines of the platform runtime, shared by the entry points of the
+// platform, which run them synchronously, and the asynchronous variants of the
+// library, which run them on a loop.
+//
+// The two need not agree: the entry points are built into the entry library
+// that ships with each platform version, whereas the asynchronous variants are
+// built into the application and spawn the runtime directly, bypassing the
+// entry library. The latter therefore hard code the command line interface of
+// the runtime as of the version of this library, and a platform whose runtime
+// changes that interface must keep accepting these command lines for as long
+// as applications built against an older version may run it.
+
+#define APPLING_COMMAND_LINK_MAX (7 /* pear:// */ + APPLING_ID_MAX + 1 /* / */ + APPLING_LINK_DATA_MAX)
+
+#define APPLING_COMMAND_ARGV_MAX 8
+
+typedef char appling_command_link_t[APPLING_COMMAND_LINK_MAX + 1 /* NULL */];
+
+static inline void
+appling_command__file(const appling_platform_t *platform, appling_path_t file) {
+  size_t path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {
+      platform->path,
+      "bin",
+#if defined(APPLING_OS_DARWIN) || defined(APPLING_OS_LINUX)
+      "pear-runtime",
+#elif defined(APPLING_OS_WIN32)
+      "pear-runtime.exe",
+#else
+#error Unsupported operating system
+#endif
+      NULL,
+    },
+    file,
+    &path_len,
+    path_behavior_system
+  );
+}
+
+static inline void
+appling_command__link(const appling_link_t *link, appling_command_link_t result) {
+  result[0] = '\0';
+
+  strcat(result, "pear://");
+  strcat(result, link->id);
+
+  if (strlen(link->data)) {
+    strcat(result, "/");
+    strcat(result, link->data);
+  }
+}
+
+static inline void
+appling_command__appling(const appling_app_t *app, appling_path_t result) {
+#if defined(APPLING_OS_LINUX)
+  char *appimage = getenv("APPIMAGE");
+
+  strcpy(result, appimage ? appimage : app->path);
+#else
+  strcpy(result, app->path);
+#endif
+}
+
+static inline void
+appling_command__ready(char *file, char *link, char *argv[APPLING_COMMAND_ARGV_MAX]) {
+  size_t i = 0;
+
+  argv[i++] = file;
+  argv[i++] = "data";
+  argv[i++] = "currents";
+  argv[i++] = link;
+  argv[i] = NULL;
+}
+
+static inline void
+appling_command__preflight(char *file, char *link, char *argv[APPLING_COMMAND_ARGV_MAX]) {
+  size_t i = 0;
+
+  argv[i++] = file;
+  argv[i++] = "run";
+  argv[i++] = "--trusted";
+  argv[i++] = "--preflight";
+  argv[i++] = link;
+  argv[i] = NULL;
+}
+
+static inline void
+appling_command__launch(char *file, char *appling, char *link, char *argv[APPLING_COMMAND_ARGV_MAX]) {
+  size_t i = 0;
+
+  argv[i++] = file;
+  argv[i++] = "run";
+  argv[i++] = "--trusted";
+  argv[i++] = "--appling";
+  argv[i++] = appling;
+
+#if defined(APPLING_OS_WIN32) || defined(APPLING_OS_LINUX)
+  argv[i++] = "--no-sandbox";
+#endif
+
+  argv[i++] = link;
+  argv[i] = NULL;
+}
+
+#endif // APPLING_COMMAND_H
@@ -0,0 +1,97 @@
+// Compresses the bootstrap bundle using the LZ4 block format and writes it out
+// as a C header, to be decompressed by `appling_lz4__decompress()` when a
+// bootstrap actually happens.
+//
+//   node compress-bundle.js <bundle> <header>
+
+const fs = require('fs')
+
+const [input, output] = process.argv.slice(2)
+
+const MIN_MATCH = 4
+const MAX_OFFSET = 65535
+const LAST_LITERALS = 5
+const MATCH_LIMIT = 12
+
+function writeLength(out, o, len) {
+  while (len >= 255) {
+    out[o++] = 255
+    len -= 255
+  }
+
+  out[o++] = len
+
+  return o
+}
+
+function writeSequence(out, o, src, start, end, offset, len) {
+  const literals = end - start
+
+  const match = len === 0 ? 0 : len - MIN_MATCH
+
+  out[o++] = (Math.min(literals, 15) << 4) | Math.min(match, 15)
+
+  if (literals >= 15) o = writeLength(out, o, literals - 15)
+
+  o += src.copy(out, o, start, end)
+
+  if (len === 0) return o // Last sequence
+
+  out[o++] = offset & 0xff
+  out[o++] = offset >> 8
+
+  if (match >= 15) o = writeLength(out, o, match - 15)
+
+  return o
+}
+
+function compress(src) {
+  const out = Buffer.alloc(src.length + Math.ceil(src.length / 255) + 16)
+  const table = new Int32Array(1 << 16).fill(-1)
+
+  let o = 0
+  let i = 0
+  let anchor = 0
+
+  while (i < src.length - MATCH_LIMIT) {
+    const sequence = src.readUInt32LE(i)
+    const hash = Math.imul(sequence, 2654435761) >>> 16
+    const ref = table[hash]
+
+    table[hash] = i
+
+    if (ref < 0 || i - ref > MAX_OFFSET || src.readUInt32LE(ref) !== sequence) {
+      i++
+      continue
+    }
+
+    let len = MIN_MATCH
+
+    while (i + len < src.length - LAST_LITERALS && src[ref + len] === src[i + len]) len++
+
+    o = writeSequence(out, o, src, anchor, i, i - ref, len)
+
+    i += len
+    anchor = i
+  }
+
+  o = writeSequence(out, o, src, anchor, src.length, 0, 0)
+
+  return out.subarray(0, o)
+}
+
+const bundle = fs.readFileSync(input)
+const compressed = compress(bundle)
+
+let header = 'static const unsigned char bootstrap_bundle_compressed[] = {'
+
+for (let i = 0; i < compressed.length; i++) {
+  if (i % 12 === 0) header += '\n  '
+  header += '0x' + compressed[i].toString(16).padStart(2, '0') + ','
+}
+
+header += '\n};\n\n'
+header += `static const unsigned int bootstrap_bundle_compressed_len = ${compressed.length};\n\n`
+header += `static const unsigned int bootstrap_bundle_len = ${bundle.length};\n`
+
+fs.writeFileSync(output, header)
@@ -0,0 +1,262 @@
+#include <log.h>
+#include <path.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#include "dedupe.h"
+#include "fs-sync.h"
+
+#define APPLING_DEDUPE_CHUNK_LEN 65536
+
+static int
+appling_dedupe__equal(uv_loop_t *loop, const char *a, const char *b, int64_t len) {
+  int err;
+
+  uv_fs_t req;
+
+  err = uv_fs_open(loop, &req, a, UV_FS_O_RDONLY, 0, NULL);
+  uv_fs_req_cleanup(&req);
+
+  if (err < 0) return err;
+
+  uv_file fa = err;
+
+  err = uv_fs_open(loop, &req, b, UV_FS_O_RDONLY, 0, NULL);
+  uv_fs_req_cleanup(&req);
+
+  if (err < 0) {
+    uv_fs_close(loop, &req, fa, NULL);
+    uv_fs_req_cleanup(&req);
+
+    return err;
+  }
+
+  uv_file fb = err;
+
+  char *data = malloc(APPLING_DEDUPE_CHUNK_LEN * 2);
+
+  int equal = data == NULL ? UV_ENOMEM : 1;
+
+  for (int64_t offset = 0; equal == 1 && offset < len;) {
+    uv_buf_t ba = uv_buf_init(data, APPLING_DEDUPE_CHUNK_LEN);
+    uv_buf_t bb = uv_buf_init(data + APPLING_DEDUPE_CHUNK_LEN, APPLING_DEDUPE_CHUNK_LEN);
+
+    int ra = uv_fs_read(loop, &req, fa, &ba, 1, offset, NULL);
+    uv_fs_req_cleanup(&req);
+
+    int rb = uv_fs_read(loop, &req, fb, &bb, 1, offset, NULL);
+    uv_fs_req_cleanup(&req);
+
+    if (ra < 0) equal = ra;
+    else if (rb < 0) equal = rb;
+    else if (ra != rb || ra == 0 || memcmp(ba.base, bb.base, ra) != 0) equal = 0;
+    else offset += ra;
+  }
+
+  free(data);
+
+  uv_fs_close(loop, &req, fa, NULL);
+  uv_fs_req_cleanup(&req);
+
+  uv_fs_close(loop, &req, fb, NULL);
+  uv_fs_req_cleanup(&req);
+
+  return equal;
+}
+
+static int
+appling_dedupe__replace(uv_loop_t *loop, const char *source, const char *target) {
+  int err;
+
+  appling_path_t tmp;
+  strcpy(tmp, target);
+  strcat(tmp, ".dedupe");
+
+  uv_fs_t req;
+
+  // Prefer a clone, which shares the data but not the file itself, and fall
+  // back to a hard link on file systems that don't support cloning.
+  err = uv_fs_copyfile(loop, &req, source, tmp, UV_FS_COPYFILE_EXCL | UV_FS_COPYFILE_FICLONE_FORCE, NULL);
+  uv_fs_req_cleanup(&req);
+
+  if (err < 0) {
+    appling_fs__rm(loop, tmp);
+
+    err = uv_fs_link(loop, &req, source, tmp, NULL);
+    uv_fs_req_cleanup(&req);
+
+    if (err < 0) return err;
+  }
+
+  err = appling_fs__rename(loop, tmp, target);
+
+  if (err < 0) appling_fs__rm(loop, tmp);
+
+  return err;
+}
+
+static int
+appling_dedupe__tree(uv_loop_t *loop, const char *previous, const char *next, uint64_t *saved) {
+  int err;
+
+  uv_fs_t req;
+  err = uv_fs_scandir(loop, &req, next, 0, NULL);
+
+  if (err < 0) {
+    uv_fs_req_cleanup(&req);
+
+    return err;
+  }
+
+  uv_dirent_t entry;
+
+  while (uv_fs_scandir_next(&req, &entry) != UV_EOF) {
+    appling_path_t a, b;
+    size_t path_len;
+
+    path_len = sizeof(appling_path_t);
+
+    path_join(
+      (const char *[]) {previous, entry.name, NULL},
+      a,
+      &path_len,
+      path_behavior_system
+    );
+
+    path_len = sizeof(appling_path_t);
+
+    path_join(
+      (const char *[]) {next, entry.name, NULL},
+      b,
+      &path_len,
+      path_behavior_system
+    );
+
+    uv_stat_t sa, sb;
+
+    if (appling_fs__lstat(loop, a, &sa) < 0 || appling_fs__lstat(loop, b, &sb) < 0) continue;
+
+    if (appling_fs__is_dir(&sa) && appling_fs__is_dir(&sb)) {
+      appling_dedupe__tree(loop, a, b, saved);
+      continue;
+    }
+
+    if ((sa.st_mode & S_IFMT) != S_IFREG || sa.st_mode != sb.st_mode) continue;
+
+    if (sa.st_size != sb.st_size || sa.st_size == 0) continue;
+
+    if (sa.st_dev != sb.st_dev) continue;
+
+    if (sa.st_ino == sb.st_ino) continue; // Already linked
+
+    if (appling_dedupe__equal(loop, a, b, (int64_t) sa.st_size) != 1) continue;
+
+    err = appling_dedupe__replace(loop, a, b);
+
+    if (err < 0) {
+      log_debug("appling_dedupe() could not deduplicate %s: %s", b, uv_strerror(err));
+      continue;
+    }
+
+    *saved += sb.st_size;
+  }
+
+  uv_fs_req_cleanup(&req);
+
+  return 0;
+}
+
+static int
+appling_dedupe__realpath(uv_loop_t *loop, const char *dir, const char *name, appling_path_t result) {
+  int err;
+
+  appling_path_t path;
+  size_t path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {dir, name, NULL},
+    path,
+    &path_len,
+    path_behavior_system
+  );
+
+  uv_fs_t req;
+  err = uv_fs_realpath(loop, &req, path, NULL);
+
+  if (err == 0) {
+    strncpy(result, (const char *) req.ptr, sizeof(appling_path_t) - 1);
+    result[sizeof(appling_path_t) - 1] = '\0';
+  }
+
+  uv_fs_req_cleanup(&req);
+
+  return err;
+}
+
+int
+appling_dedupe__run(uv_loop_t *loop, const char *dir, uint64_t *saved) {
+  int err;
+
+  appling_path_t current, next, previous;
+
+  err = appling_dedupe__realpath(loop, dir, "current", current);
+  if (err < 0) return err == UV_ENOENT ? 0 : err;
+
+  size_t path_len = sizeof(appling_path_t);
+  size_t len = strlen(current);
+
+  // An update installs the new version into the slot that `current` doesn't
+  // point to and links it as `next`, whereas a bootstrap links it as `current`
+  // directly, leaving the version before it in the other slot.
+  if (appling_dedupe__realpath(loop, dir, "next", next) == 0) {
+    if (strcmp(next, current) == 0) return 0;
+
+    strcpy(previous, current);
+  } else {
+    strcpy(next, current);
+
+    path_join(
+      (const char *[]) {current, "..", current[len - 1] == '0' ? "1" : "0", NULL},
+      previous,
+      &path_len,
+      path_behavior_system
+    );
+  }
+
+  // Only the versions of the same platform share anything worth linking.
+  appling_path_t a, b;
+
+  path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {previous, "..", NULL},
+    a,
+    &path_len,
+    path_behavior_system
+  );
+
+  path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {next, "..", NULL},
+    b,
+    &path_len,
+    path_behavior_system
+  );
+
+  if (strcmp(a, b) != 0) return 0;
+
+  uv_stat_t stat;
+  err = appling_fs__lstat(loop, previous, &stat);
+  if (err < 0 || !appling_fs__is_dir(&stat)) return 0;
+
+  log_debug("appling_dedupe() deduplicating %s against %s", next, previous);
+
+  return appling_dedupe__tree(loop, previous, next, saved);
+}
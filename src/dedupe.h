@@ -0,0 +1,15 @@
+#ifndef APPLING_DEDUPE_H
+#define APPLING_DEDUPE_H
+
+#include <stdint.h>
+#include <uv.h>
+
+// Replace the files of the platform version most recently installed in a
+// platform directory, that is the target of `next` or else of `current`, that
+// are identical to those of the version it replaces with clones or hard links,
+// adding the number of bytes saved to `saved`. Files that can't be
+// deduplicated are left as they are.
+int
+appling_dedupe__run(uv_loop_t *loop, const char *dir, uint64_t *saved);
+
+#endif // APPLING_DEDUPE_H
@@ -1,3 +1,7 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // For pipe2()
+#endif
+
 #include <log.h>
 #include <path.h>
 #include <stdlib.h>
@@ -6,17 +10,33 @@
 
 #include "../include/appling.h"
 
+#include "command.h"
+#include "progress.h"
+
 #if defined(APPLING_OS_WIN32)
 #define _CRT_SECURE_NO_WARNINGS
 #include <process.h>
 #include <wchar.h>
 #include <windows.h>
 #else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
 #include <sys/wait.h>
 #include <unistd.h>
+
+#if defined(APPLING_OS_DARWIN)
+#include <crt_externs.h>
+
+// Shared libraries on Darwin have no direct access to `environ`, which is only
+// defined for the main executable.
+#define environ (*_NSGetEnviron())
+#else
+extern char **environ;
+#endif
 #endif
 
-#if defined(APPLING_OS_WIN32)
 static void
 appling__bootstrap_log(const char *tag, const char *detail) {
   const char *log_path = getenv("PEAR_BOOTSTRAP_LOG");
@@ -25,7 +45,11 @@ appling__bootstrap_log(const char *tag, const char *detail) {
   FILE *fp = fopen(log_path, "a");
   if (fp == NULL) return;
 
+#if defined(APPLING_OS_WIN32)
   unsigned long long ts = (unsigned long long) GetTickCount64();
+#else
+  unsigned long long ts = (unsigned long long) uv_hrtime();
+#endif
   fprintf(fp, "[%llu] %s: %s\n",
     ts,
     tag ? tag : "event",
@@ -34,6 +58,169 @@ appling__bootstrap_log(const char *tag, const char *detail) {
   fclose(fp);
 }
 
+#if !defined(APPLING_OS_WIN32)
+// Run a program to completion and return its exit status, or -1 if it could
+// not be waited on or did not exit normally. Unlike fork(), posix_spawn() does
+// not copy the page tables of the calling process, which for a large host
+// process is the bulk of the cost of starting a child. A program that can't be
+// executed is reported as having exited with status 1, as it was when the
+// child called `_exit(1)` after a failed `execv()`.
+static int
+appling__spawn(const char *file, char *const argv[]) {
+  int err;
+
+  pid_t pid;
+  err = posix_spawn(&pid, file, NULL, NULL, argv, environ);
+  if (err == EAGAIN || err == ENOMEM) return -1;
+  if (err != 0) return 1;
+
+  int status;
+
+  do err = waitpid(pid, &status, 0);
+  while (err < 0 && errno == EINTR);
+
+  if (err < 0) return -1;
+
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// Run a program to completion as with appling__spawn(), forwarding the progress
+// it reports over an inherited pipe. Should the pipe or the environment of the
+// program not be set up, it is run without reporting progress instead.
+static int
+appling__spawn_with_progress(const char *file, char *const argv[], appling_progress_cb cb) {
+  int err;
+
+  // Only the duplicate of the write end made for the program may outlive the
+  // spawn, lest the pipe be held open by it or by anything else spawned by the
+  // host in the meantime. Where pipe2() is missing, there is a window between
+  // creating the pipe and marking it close-on-exec in which another thread of
+  // the host may spawn a process that inherits it.
+  int fds[2];
+
+#if defined(APPLING_OS_LINUX)
+  err = pipe2(fds, O_CLOEXEC);
+  if (err < 0) return appling__spawn(file, argv);
+#else
+  err = pipe(fds);
+  if (err < 0) return appling__spawn(file, argv);
+
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+#endif
+
+  // Duplicating the write end onto itself leaves it close-on-exec, so it must
+  // be cleared should the pipe have been given the descriptor of the program.
+  if (fds[1] == APPLING_PROGRESS_FD) fcntl(fds[1], F_SETFD, 0);
+
+  size_t env_len = 0;
+  while (environ[env_len]) env_len++;
+
+  char **env = malloc((env_len + 2) * sizeof(char *));
+
+  if (env == NULL) {
+    close(fds[0]);
+    close(fds[1]);
+
+    return appling__spawn(file, argv);
+  }
+
+  size_t i = 0;
+
+  for (size_t j = 0; j < env_len; j++) {
+    if (strncmp(environ[j], APPLING_PROGRESS_ENV "=", strlen(APPLING_PROGRESS_ENV "=")) == 0) continue;
+
+    env[i++] = environ[j];
+  }
+
+  char fd[32];
+  snprintf(fd, sizeof(fd), "%s=%d", APPLING_PROGRESS_ENV, APPLING_PROGRESS_FD);
+
+  env[i++] = fd;
+  env[i] = NULL;
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, fds[1], APPLING_PROGRESS_FD);
+
+  pid_t pid;
+  err = posix_spawn(&pid, file, &actions, NULL, argv, env);
+
+  posix_spawn_file_actions_destroy(&actions);
+
+  free(env);
+
+  close(fds[1]);
+
+  if (err != 0) {
+    close(fds[0]);
+
+    return err == EAGAIN || err == ENOMEM ? -1 : 1;
+  }
+
+  appling_progress_t progress;
+  appling_progress__init(&progress, cb);
+
+  int status;
+
+  bool exited = false;
+
+  // What the program wrote before exiting fits in the pipe, which holds no
+  // more than 64 KiB by default, or it would not have been able to exit.
+  size_t unread = 64 * 1024;
+
+  struct pollfd pfd = {.fd = fds[0], .events = POLLIN};
+
+  for (;;) {
+    // The pipe may outlive the program if it was passed on to a process of its
+    // own, so stop listening once the program has exited, however busy the
+    // pipe is, after reading what it had already written.
+    if (!exited && waitpid(pid, &status, WNOHANG) == pid) exited = true;
+
+    err = poll(&pfd, 1, exited ? 0 : APPLING_PROGRESS_INTERVAL);
+
+    if (err < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+
+    if (err == 0) {
+      if (exited) break;
+      continue;
+    }
+
+    uint8_t data[APPLING_PROGRESS_BUFFER_MAX];
+
+    ssize_t len = read(fds[0], data, sizeof(data));
+
+    if (len < 0 && errno == EINTR) continue;
+    if (len <= 0) break;
+
+    appling_progress__push(&progress, data, (size_t) len);
+
+    if (exited) {
+      if ((size_t) len >= unread) break;
+
+      unread -= (size_t) len;
+    }
+  }
+
+  appling_progress__flush(&progress);
+
+  close(fds[0]);
+
+  if (!exited) {
+    do err = waitpid(pid, &status, 0);
+    while (err < 0 && errno == EINTR);
+
+    if (err < 0) return -1;
+  }
+
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+#endif
+
+#if defined(APPLING_OS_WIN32)
 static inline int32_t
 appling__wtf8_decode1(const char **input) {
   uint32_t code_point;
@@ -226,48 +413,15 @@ appling_ready_v0(const appling_ready_info_t *info) {
   int err;
 
   appling_path_t file;
+  appling_command__file(info->platform, file);
 
-  size_t path_len = sizeof(appling_path_t);
-
-  path_join(
-    (const char *[]) {
-      info->platform->path,
-      "bin",
-#if defined(APPLING_OS_DARWIN) || defined(APPLING_OS_LINUX)
-      "pear-runtime",
-#elif defined(APPLING_OS_WIN32)
-      "pear-runtime.exe",
-#else
-#error Unsupported operating system
-#endif
-      NULL,
-    },
-    file,
-    &path_len,
-    path_behavior_system
-  );
-
-  char link[7 /* pear:// */ + APPLING_ID_MAX + 1 /* / */ + APPLING_LINK_DATA_MAX + 1 /* NULL */] = {'\0'};
-
-  strcat(link, "pear://");
-  strcat(link, info->link->id);
-
-  if (strlen(info->link->data)) {
-    strcat(link, "/");
-    strcat(link, info->link->data);
-  }
+  appling_command_link_t link;
+  appling_command__link(info->link, link);
 
   log_debug("appling_ready() running for link %s", link);
 
-  char *argv[5];
-
-  size_t i = 0;
-
-  argv[i++] = file;
-  argv[i++] = "data";
-  argv[i++] = "currents";
-  argv[i++] = link;
-  argv[i] = NULL;
+  char *argv[APPLING_COMMAND_ARGV_MAX];
+  appling_command__ready(file, link, argv);
 
 #if defined(APPLING_OS_WIN32)
   STARTUPINFOW si;
@@ -332,19 +486,10 @@ appling_ready_v0(const appling_ready_info_t *info) {
 
   return success ? status == 0 : -1;
 #else
-  pid_t pid = fork();
-  if (pid < 0) return -1;
-  if (pid != 0) {
-    int status;
-    err = waitpid(pid, &status, 0);
-    if (err < 0) return -1;
-
-    return WIFEXITED(status) ? WEXITSTATUS(status) == 0 : -1;
-  }
+  err = appling__spawn(file, argv);
+  if (err < 0) return -1;
 
-  execv(file, argv);
-
-  _exit(1);
+  return err == 0;
 #endif
 }
 
@@ -353,49 +498,15 @@ appling_preflight_v0(const appling_preflight_info_t *info) {
   int err;
 
   appling_path_t file;
+  appling_command__file(info->platform, file);
 
-  size_t path_len = sizeof(appling_path_t);
-
-  path_join(
-    (const char *[]) {
-      info->platform->path,
-      "bin",
-#if defined(APPLING_OS_DARWIN) || defined(APPLING_OS_LINUX)
-      "pear-runtime",
-#elif defined(APPLING_OS_WIN32)
-      "pear-runtime.exe",
-#else
-#error Unsupported operating system
-#endif
-      NULL,
-    },
-    file,
-    &path_len,
-    path_behavior_system
-  );
-
-  char link[7 /* pear:// */ + APPLING_ID_MAX + 1 /* / */ + APPLING_LINK_DATA_MAX + 1 /* NULL */] = {'\0'};
-
-  strcat(link, "pear://");
-  strcat(link, info->link->id);
-
-  if (strlen(info->link->data)) {
-    strcat(link, "/");
-    strcat(link, info->link->data);
-  }
+  appling_command_link_t link;
+  appling_command__link(info->link, link);
 
   log_debug("appling_preflight() running for link %s", link);
 
-  char *argv[6];
-
-  size_t i = 0;
-
-  argv[i++] = file;
-  argv[i++] = "run";
-  argv[i++] = "--trusted";
-  argv[i++] = "--preflight";
-  argv[i++] = link;
-  argv[i] = NULL;
+  char *argv[APPLING_COMMAND_ARGV_MAX];
+  appling_command__preflight(file, link, argv);
 
 #if defined(APPLING_OS_WIN32)
   STARTUPINFOW si;
@@ -462,19 +573,10 @@ appling_preflight_v0(const appling_preflight_info_t *info) {
 
   return success && status == 0 ? 0 : -1;
 #else
-  pid_t pid = fork();
-  if (pid < 0) return -1;
-  if (pid != 0) {
-    int status;
-    err = waitpid(pid, &status, 0);
-    if (err < 0) return -1;
-
-    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
-  }
-
-  execv(file, argv);
+  if (info->progress) err = appling__spawn_with_progress(file, argv, info->progress);
+  else err = appling__spawn(file, argv);
 
-  _exit(1);
+  return err == 0 ? 0 : -1;
 #endif
 }
 
@@ -483,26 +585,7 @@ appling_launch_v0(const appling_launch_info_t *info) {
   int err;
 
   appling_path_t file;
-
-  size_t path_len = sizeof(appling_path_t);
-
-  path_join(
-    (const char *[]) {
-      info->platform->path,
-      "bin",
-#if defined(APPLING_OS_DARWIN) || defined(APPLING_OS_LINUX)
-      "pear-runtime",
-#elif defined(APPLING_OS_WIN32)
-      "pear-runtime.exe",
-#else
-#error Unsupported operating system
-#endif
-      NULL,
-    },
-    file,
-    &path_len,
-    path_behavior_system
-  );
+  appling_command__file(info->platform, file);
 
   appling__bootstrap_log("launch-entrypoint", "v0");
   appling__bootstrap_log("launch-runtime", file);
@@ -510,49 +593,21 @@ appling_launch_v0(const appling_launch_info_t *info) {
   const appling_app_t *app = info->app;
 
   appling_path_t appling;
-
-#if defined(APPLING_OS_LINUX)
-  char *appimage = getenv("APPIMAGE");
-
-  strcpy(appling, appimage ? appimage : app->path);
-#else
-  strcpy(appling, app->path);
-#endif
+  appling_command__appling(app, appling);
 
   appling__bootstrap_log("launch-appling", appling);
 
   log_debug("appling_launch() launching application shell %s", appling);
 
-  char link[7 /* pear:// */ + APPLING_ID_MAX + 1 /* / */ + APPLING_LINK_DATA_MAX + 1 /* NULL */] = {'\0'};
-
-  strcat(link, "pear://");
-  strcat(link, info->link->id);
-
-  if (strlen(info->link->data)) {
-    strcat(link, "/");
-    strcat(link, info->link->data);
-  }
+  appling_command_link_t link;
+  appling_command__link(info->link, link);
 
   appling__bootstrap_log("launch-link", link);
 
   log_debug("appling_launch() launching link %s", link);
 
-  char *argv[8];
-
-  size_t i = 0;
-
-  argv[i++] = file;
-  argv[i++] = "run";
-  argv[i++] = "--trusted";
-  argv[i++] = "--appling";
-  argv[i++] = appling;
-
-#if defined(APPLING_OS_WIN32) || defined(APPLING_OS_LINUX)
-  argv[i++] = "--no-sandbox";
-#endif
-
-  argv[i++] = link;
-  argv[i] = NULL;
+  char *argv[APPLING_COMMAND_ARGV_MAX];
+  appling_command__launch(file, appling, link, argv);
 
 #if defined(APPLING_OS_WIN32)
   {
@@ -0,0 +1,271 @@
+#ifndef APPLING_FS_SYNC_H
+#define APPLING_FS_SYNC_H
+
+#include <path.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+// Synchronous file system helpers for use on threads that own their loop,
+// such as the bootstrap thread, where chaining asynchronous requests buys
+// nothing.
+
+static inline int
+appling_fs__mkdir(uv_loop_t *loop, const char *dir) {
+  int err = 0;
+
+  appling_path_t path;
+  strcpy(path, dir);
+
+  for (char *p = path + 1;; p++) {
+    char c = *p;
+
+    if (c != '/' && c != '\\' && c != '\0') continue;
+
+    *p = '\0';
+
+    uv_fs_t req;
+    err = uv_fs_mkdir(loop, &req, path, 0777, NULL);
+    uv_fs_req_cleanup(&req);
+
+    *p = c;
+
+    if (c == '\0') break;
+  }
+
+  return err == UV_EEXIST ? 0 : err;
+}
+
+static inline int
+appling_fs__lstat(uv_loop_t *loop, const char *path, uv_stat_t *result) {
+  int err;
+
+  uv_fs_t req;
+  err = uv_fs_lstat(loop, &req, path, NULL);
+
+  if (err == 0) *result = req.statbuf;
+
+  uv_fs_req_cleanup(&req);
+
+  return err;
+}
+
+static inline bool
+appling_fs__is_dir(const uv_stat_t *stat) {
+  return (stat->st_mode & S_IFMT) == S_IFDIR;
+}
+
+static inline bool
+appling_fs__is_link(const uv_stat_t *stat) {
+#if defined(S_IFLNK)
+  return (stat->st_mode & S_IFMT) == S_IFLNK;
+#else
+  return false;
+#endif
+}
+
+static inline int
+appling_fs__rm(uv_loop_t *loop, const char *path) {
+  int err;
+
+  uv_stat_t stat;
+  err = appling_fs__lstat(loop, path, &stat);
+  if (err < 0) return err == UV_ENOENT ? 0 : err;
+
+  uv_fs_t req;
+
+  if (!appling_fs__is_dir(&stat)) {
+    err = uv_fs_unlink(loop, &req, path, NULL);
+    uv_fs_req_cleanup(&req);
+
+    return err;
+  }
+
+  err = uv_fs_scandir(loop, &req, path, 0, NULL);
+
+  if (err >= 0) {
+    uv_dirent_t entry;
+
+    while (uv_fs_scandir_next(&req, &entry) != UV_EOF) {
+      appling_path_t child;
+      size_t path_len = sizeof(appling_path_t);
+
+      path_join(
+        (const char *[]) {path, entry.name, NULL},
+        child,
+        &path_len,
+        path_behavior_system
+      );
+
+      err = appling_fs__rm(loop, child);
+      if (err < 0) break;
+    }
+  }
+
+  uv_fs_req_cleanup(&req);
+
+  if (err < 0) return err;
+
+  err = uv_fs_rmdir(loop, &req, path, NULL);
+  uv_fs_req_cleanup(&req);
+
+  return err;
+}
+
+static inline int
+appling_fs__copy(uv_loop_t *loop, const char *from, const char *to) {
+  int err;
+
+  uv_stat_t stat;
+  err = appling_fs__lstat(loop, from, &stat);
+  if (err < 0) return err;
+
+  uv_fs_t req;
+
+  if (appling_fs__is_link(&stat)) {
+    err = uv_fs_readlink(loop, &req, from, NULL);
+
+    if (err == 0) {
+      uv_fs_t symlink;
+      err = uv_fs_symlink(loop, &symlink, (const char *) req.ptr, to, 0, NULL);
+      uv_fs_req_cleanup(&symlink);
+    }
+
+    uv_fs_req_cleanup(&req);
+
+    return err;
+  }
+
+  if (!appling_fs__is_dir(&stat)) {
+    err = uv_fs_copyfile(loop, &req, from, to, UV_FS_COPYFILE_EXCL | UV_FS_COPYFILE_FICLONE, NULL);
+    uv_fs_req_cleanup(&req);
+
+    return err;
+  }
+
+  err = uv_fs_mkdir(loop, &req, to, (int) (stat.st_mode & 0777), NULL);
+  uv_fs_req_cleanup(&req);
+
+  if (err < 0 && err != UV_EEXIST) return err;
+
+  err = uv_fs_scandir(loop, &req, from, 0, NULL);
+
+  if (err >= 0) {
+    uv_dirent_t entry;
+
+    while (uv_fs_scandir_next(&req, &entry) != UV_EOF) {
+      appling_path_t source, target;
+      size_t path_len;
+
+      path_len = sizeof(appling_path_t);
+
+      path_join(
+        (const char *[]) {from, entry.name, NULL},
+        source,
+        &path_len,
+        path_behavior_system
+      );
+
+      path_len = sizeof(appling_path_t);
+
+      path_join(
+        (const char *[]) {to, entry.name, NULL},
+        target,
+        &path_len,
+        path_behavior_system
+      );
+
+      err = appling_fs__copy(loop, source, target);
+      if (err < 0) break;
+    }
+  }
+
+  uv_fs_req_cleanup(&req);
+
+  return err < 0 ? err : 0;
+}
+
+static inline int
+appling_fs__symlink(uv_loop_t *loop, const char *target, const char *path) {
+  int err;
+
+  uv_fs_t req;
+  err = uv_fs_symlink(loop, &req, target, path, UV_FS_SYMLINK_JUNCTION, NULL);
+  uv_fs_req_cleanup(&req);
+
+  return err;
+}
+
+static inline int
+appling_fs__rename(uv_loop_t *loop, const char *from, const char *to) {
+  int err;
+
+  uv_fs_t req;
+  err = uv_fs_rename(loop, &req, from, to, NULL);
+  uv_fs_req_cleanup(&req);
+
+  return err;
+}
+
+// Read a whole file of no more than `max` bytes into a buffer that the caller
+// must free.
+static inline int
+appling_fs__read_file(uv_loop_t *loop, const char *path, size_t max, uv_buf_t *buf) {
+  int err;
+
+  *buf = uv_buf_init(NULL, 0);
+
+  uv_fs_t req;
+  err = uv_fs_open(loop, &req, path, UV_FS_O_RDONLY, 0, NULL);
+  uv_fs_req_cleanup(&req);
+  if (err < 0) return err;
+
+  uv_file file = err;
+
+  err = uv_fs_fstat(loop, &req, file, NULL);
+
+  size_t len = (size_t) req.statbuf.st_size;
+
+  uv_fs_req_cleanup(&req);
+
+  if (err == 0 && len > max) err = UV_EFBIG;
+
+  if (err == 0) {
+    *buf = uv_buf_init(malloc(len), len);
+
+    if (buf->base == NULL && len > 0) err = UV_ENOMEM;
+  }
+
+  size_t read = 0;
+
+  while (err == 0 && read < len) {
+    uv_buf_t chunk = uv_buf_init(buf->base + read, len - read);
+
+    err = uv_fs_read(loop, &req, file, &chunk, 1, read, NULL);
+    uv_fs_req_cleanup(&req);
+
+    if (err <= 0) {
+      if (err == 0) err = UV_EIO; // Truncated while reading
+      break;
+    }
+
+    read += err;
+    err = 0;
+  }
+
+  uv_fs_close(loop, &req, file, NULL);
+  uv_fs_req_cleanup(&req);
+
+  if (err < 0 && buf->base) {
+    free(buf->base);
+
+    *buf = uv_buf_init(NULL, 0);
+  }
+
+  return err;
+}
+
+#endif // APPLING_FS_SYNC_H
@@ -0,0 +1,670 @@
+#include <compact.h>
+#include <log.h>
+#include <path.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#include "fs-sync.h"
+#include "gc.h"
+#include "platform-dir.h"
+
+#define APPLING_GC_CONCURRENCY 4
+
+static uv_once_t appling_gc__guard = UV_ONCE_INIT;
+
+static uv_mutex_t appling_gc__lock;
+static uv_cond_t appling_gc__idle;
+
+static size_t appling_gc__resolving = 0;
+static bool appling_gc__collecting = false;
+
+// The resolves waiting for a collection to finish, each woken through its own
+// async handle on the loop it runs on.
+static uv_async_t **appling_gc__waiting = NULL;
+static size_t appling_gc__waiting_len = 0;
+
+static void
+appling_gc__init(void) {
+  int err;
+
+  err = uv_mutex_init(&appling_gc__lock);
+  if (err < 0) abort();
+
+  err = uv_cond_init(&appling_gc__idle);
+  if (err < 0) abort();
+}
+
+int
+appling_gc__enter_resolve(uv_loop_t *loop, uv_async_t *resume, uv_async_cb cb) {
+  int err;
+
+  uv_once(&appling_gc__guard, appling_gc__init);
+
+  uv_mutex_lock(&appling_gc__lock);
+
+  if (!appling_gc__collecting) {
+    appling_gc__resolving++;
+
+    uv_mutex_unlock(&appling_gc__lock);
+
+    return 0;
+  }
+
+  uv_async_t **waiting = realloc(appling_gc__waiting, (appling_gc__waiting_len + 1) * sizeof(uv_async_t *));
+
+  if (waiting == NULL) {
+    err = UV_ENOMEM;
+    goto err;
+  }
+
+  appling_gc__waiting = waiting;
+
+  err = uv_async_init(loop, resume, cb);
+  if (err < 0) goto err;
+
+  appling_gc__waiting[appling_gc__waiting_len++] = resume;
+
+  uv_mutex_unlock(&appling_gc__lock);
+
+  return 1;
+
+err:
+  uv_mutex_unlock(&appling_gc__lock);
+
+  return err;
+}
+
+void
+appling_gc__leave_resolve(void) {
+  uv_mutex_lock(&appling_gc__lock);
+
+  if (--appling_gc__resolving == 0) uv_cond_broadcast(&appling_gc__idle);
+
+  uv_mutex_unlock(&appling_gc__lock);
+}
+
+static void
+appling_gc__enter_collect(void) {
+  uv_once(&appling_gc__guard, appling_gc__init);
+
+  uv_mutex_lock(&appling_gc__lock);
+
+  while (appling_gc__resolving > 0 || appling_gc__collecting) uv_cond_wait(&appling_gc__idle, &appling_gc__lock);
+
+  appling_gc__collecting = true;
+
+  uv_mutex_unlock(&appling_gc__lock);
+}
+
+static void
+appling_gc__leave_collect(void) {
+  uv_mutex_lock(&appling_gc__lock);
+
+  appling_gc__collecting = false;
+
+  // The waiting resolves enter before any other collection can, so that they
+  // aren't starved by one that follows right after.
+  for (size_t i = 0; i < appling_gc__waiting_len; i++) {
+    appling_gc__resolving++;
+
+    uv_async_send(appling_gc__waiting[i]);
+  }
+
+  appling_gc__waiting_len = 0;
+
+  uv_cond_broadcast(&appling_gc__idle);
+
+  uv_mutex_unlock(&appling_gc__lock);
+}
+
+typedef struct {
+  appling_path_t path;
+  bool installed;
+  uint64_t length;
+  uint64_t fork;
+  uint64_t size;
+} appling_gc__version_t;
+
+typedef struct {
+  char *path;
+  appling_gc__version_t *version;
+} appling_gc__entry_t;
+
+// The sizes of the stale versions are measured by a number of threads that
+// share a stack of directories still to be walked, which finishes once the
+// stack is empty and no thread is walking a directory that may add to it.
+typedef struct {
+  uv_mutex_t lock;
+  uv_cond_t available;
+
+  appling_gc__entry_t *entries;
+  size_t len;
+  size_t capacity;
+
+  size_t busy;
+} appling_gc__walk_t;
+
+static int
+appling_gc__push(appling_gc__walk_t *walk, const char *path, appling_gc__version_t *version) {
+  char *copy = strdup(path);
+  if (copy == NULL) return UV_ENOMEM;
+
+  uv_mutex_lock(&walk->lock);
+
+  if (walk->len == walk->capacity) {
+    size_t capacity = walk->capacity ? walk->capacity * 2 : 64;
+
+    appling_gc__entry_t *entries = realloc(walk->entries, capacity * sizeof(appling_gc__entry_t));
+
+    if (entries == NULL) {
+      uv_mutex_unlock(&walk->lock);
+
+      free(copy);
+
+      return UV_ENOMEM;
+    }
+
+    walk->entries = entries;
+    walk->capacity = capacity;
+  }
+
+  walk->entries[walk->len++] = (appling_gc__entry_t) {copy, version};
+
+  uv_cond_signal(&walk->available);
+
+  uv_mutex_unlock(&walk->lock);
+
+  return 0;
+}
+
+static void
+appling_gc__measure(appling_gc__walk_t *walk, uv_loop_t *loop, const appling_gc__entry_t *entry) {
+  int err;
+
+  uint64_t size = 0;
+
+  uv_fs_t req;
+  err = uv_fs_scandir(loop, &req, entry->path, 0, NULL);
+
+  if (err >= 0) {
+    uv_dirent_t dirent;
+
+    while (uv_fs_scandir_next(&req, &dirent) != UV_EOF) {
+      appling_path_t path;
+      size_t path_len = sizeof(appling_path_t);
+
+      path_join(
+        (const char *[]) {entry->path, dirent.name, NULL},
+        path,
+        &path_len,
+        path_behavior_system
+      );
+
+      uv_stat_t stat;
+      err = appling_fs__lstat(loop, path, &stat);
+      if (err < 0) continue;
+
+      if (appling_fs__is_dir(&stat)) appling_gc__push(walk, path, entry->version);
+
+      // Removing a file that is still linked from elsewhere frees nothing.
+      else if (stat.st_nlink <= 1) size += stat.st_size;
+    }
+  }
+
+  uv_fs_req_cleanup(&req);
+
+  uv_mutex_lock(&walk->lock);
+
+  entry->version->size += size;
+
+  uv_mutex_unlock(&walk->lock);
+}
+
+static void
+appling_gc__walk(void *data) {
+  int err;
+
+  appling_gc__walk_t *walk = (appling_gc__walk_t *) data;
+
+  uv_loop_t loop;
+  err = uv_loop_init(&loop);
+  if (err < 0) return;
+
+  uv_mutex_lock(&walk->lock);
+
+  for (;;) {
+    while (walk->len == 0 && walk->busy > 0) uv_cond_wait(&walk->available, &walk->lock);
+
+    if (walk->len == 0) break;
+
+    appling_gc__entry_t entry = walk->entries[--walk->len];
+
+    walk->busy++;
+
+    uv_mutex_unlock(&walk->lock);
+
+    appling_gc__measure(walk, &loop, &entry);
+
+    free(entry.path);
+
+    uv_mutex_lock(&walk->lock);
+
+    walk->busy--;
+  }
+
+  // Wake the other threads so that they too see that the walk is done.
+  uv_cond_broadcast(&walk->available);
+
+  uv_mutex_unlock(&walk->lock);
+
+  uv_loop_close(&loop);
+}
+
+// Read the length and fork of a version from its checkout, which is only
+// written once the version is installed.
+static bool
+appling_gc__checkout(uv_loop_t *loop, appling_gc__version_t *version) {
+  int err;
+
+  appling_path_t path;
+  size_t path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {version->path, "checkout", NULL},
+    path,
+    &path_len,
+    path_behavior_system
+  );
+
+  uv_buf_t buf;
+  err = appling_fs__read_file(loop, path, 256, &buf);
+  if (err < 0) return false;
+
+  compact_state_t state = {0, buf.len, (uint8_t *) buf.base};
+
+  appling_key_t key;
+  uintmax_t length, fork;
+
+  err = compact_decode_fixed32(&state, key);
+  if (err == 0) err = compact_decode_uint(&state, &length);
+  if (err == 0) err = compact_decode_uint(&state, &fork);
+
+  free(buf.base);
+
+  if (err < 0) return false;
+
+  version->length = length;
+  version->fork = fork;
+
+  return true;
+}
+
+// Order versions from newest to oldest. The slots that versions are installed
+// in say nothing of their order, so the checkouts are compared instead, with
+// versions that are still being installed considered the newest.
+static int
+appling_gc__compare(const void *a, const void *b) {
+  const appling_gc__version_t *va = (const appling_gc__version_t *) a;
+  const appling_gc__version_t *vb = (const appling_gc__version_t *) b;
+
+  if (va->installed != vb->installed) return va->installed ? 1 : -1;
+
+  if (va->fork != vb->fork) return va->fork < vb->fork ? 1 : -1;
+
+  return va->length < vb->length ? 1 : va->length > vb->length ? -1 : 0;
+}
+
+static int
+appling_gc__realpath(uv_loop_t *loop, const char *path, appling_path_t result) {
+  int err;
+
+  uv_fs_t req;
+  err = uv_fs_realpath(loop, &req, path, NULL);
+
+  if (err == 0) {
+    strncpy(result, (const char *) req.ptr, sizeof(appling_path_t) - 1);
+    result[sizeof(appling_path_t) - 1] = '\0';
+  }
+
+  uv_fs_req_cleanup(&req);
+
+  return err;
+}
+
+// Add the versions of a discovery key that are stale to `stale`. Versions that
+// are newer than the newest referenced version may still be being installed,
+// as may any version of a key without references, so those are always kept.
+static int
+appling_gc__dkey(appling_gc_t *req, uv_loop_t *loop, const char *base, appling_path_t references[2], appling_gc__version_t **stale, size_t *stale_len) {
+  int err;
+
+  uv_fs_t fs;
+  err = uv_fs_scandir(loop, &fs, base, 0, NULL);
+
+  if (err < 0) {
+    uv_fs_req_cleanup(&fs);
+
+    return err;
+  }
+
+  appling_gc__version_t *versions = NULL;
+  size_t len = 0;
+
+  uv_dirent_t entry;
+
+  while (uv_fs_scandir_next(&fs, &entry) != UV_EOF) {
+    if (entry.type != UV_DIRENT_DIR) continue;
+
+    appling_gc__version_t *next = realloc(versions, (len + 1) * sizeof(appling_gc__version_t));
+
+    if (next == NULL) {
+      err = UV_ENOMEM;
+      break;
+    }
+
+    versions = next;
+
+    appling_gc__version_t *version = &versions[len++];
+
+    size_t path_len = sizeof(appling_path_t);
+
+    path_join(
+      (const char *[]) {base, entry.name, NULL},
+      version->path,
+      &path_len,
+      path_behavior_system
+    );
+
+    version->length = 0;
+    version->fork = 0;
+    version->size = 0;
+    version->installed = appling_gc__checkout(loop, version);
+  }
+
+  uv_fs_req_cleanup(&fs);
+
+  if (err < 0) goto done;
+
+  qsort(versions, len, sizeof(appling_gc__version_t), appling_gc__compare);
+
+  size_t newest = len; // Index of the newest referenced version
+
+  for (size_t i = 0; i < len && newest == len; i++) {
+    appling_path_t path;
+    if (appling_gc__realpath(loop, versions[i].path, path) < 0) continue;
+
+    for (int j = 0; j < 2; j++) {
+      if (references[j][0] != '\0' && strcmp(path, references[j]) == 0) newest = i;
+    }
+  }
+
+  for (size_t i = newest + 1 + req->retain; i < len; i++) {
+    appling_path_t path;
+    if (appling_gc__realpath(loop, versions[i].path, path) < 0) continue;
+
+    if (strcmp(path, references[0]) == 0 || strcmp(path, references[1]) == 0) continue;
+
+    appling_gc__version_t *next = realloc(*stale, (*stale_len + 1) * sizeof(appling_gc__version_t));
+
+    if (next == NULL) {
+      err = UV_ENOMEM;
+      break;
+    }
+
+    *stale = next;
+
+    (*stale)[(*stale_len)++] = versions[i];
+  }
+
+done:
+  free(versions);
+
+  return err < 0 ? err : 0;
+}
+
+static void
+appling_gc__on_work(uv_work_t *handle) {
+  int err;
+
+  appling_gc_t *req = (appling_gc_t *) handle->data;
+
+  uv_loop_t loop;
+  err = uv_loop_init(&loop);
+
+  if (err < 0) {
+    req->status = err;
+    return;
+  }
+
+  appling_path_t references[2];
+
+  const char *names[] = {"current", "next"};
+
+  for (int i = 0; i < 2; i++) {
+    appling_path_t path;
+    size_t path_len = sizeof(appling_path_t);
+
+    path_join(
+      (const char *[]) {req->dir, names[i], NULL},
+      path,
+      &path_len,
+      path_behavior_system
+    );
+
+    if (appling_gc__realpath(&loop, path, references[i]) < 0) references[i][0] = '\0';
+  }
+
+  appling_path_t by_dkey;
+  size_t path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {req->dir, "by-dkey", NULL},
+    by_dkey,
+    &path_len,
+    path_behavior_system
+  );
+
+  appling_gc__version_t *stale = NULL;
+  size_t stale_len = 0;
+
+  uv_fs_t fs;
+  err = uv_fs_scandir(&loop, &fs, by_dkey, 0, NULL);
+
+  if (err >= 0) {
+    uv_dirent_t entry;
+
+    while (uv_fs_scandir_next(&fs, &entry) != UV_EOF) {
+      appling_path_t base;
+      path_len = sizeof(appling_path_t);
+
+      path_join(
+        (const char *[]) {by_dkey, entry.name, NULL},
+        base,
+        &path_len,
+        path_behavior_system
+      );
+
+      err = appling_gc__dkey(req, &loop, base, references, &stale, &stale_len);
+      if (err < 0) break;
+    }
+  }
+
+  uv_fs_req_cleanup(&fs);
+
+  if (err == UV_ENOENT) err = 0;
+
+  if (err < 0 || stale_len == 0) goto done;
+
+  appling_gc__walk_t walk = {
+    .entries = NULL,
+    .len = 0,
+    .capacity = 0,
+    .busy = 0,
+  };
+
+  uv_mutex_init(&walk.lock);
+  uv_cond_init(&walk.available);
+
+  for (size_t i = 0; i < stale_len; i++) {
+    err = appling_gc__push(&walk, stale[i].path, &stale[i]);
+    if (err < 0) break;
+  }
+
+  if (err == 0) {
+    uv_thread_t threads[APPLING_GC_CONCURRENCY - 1];
+    size_t threads_len = 0;
+
+    for (size_t i = 0; i < APPLING_GC_CONCURRENCY - 1; i++) {
+      if (uv_thread_create(&threads[threads_len], appling_gc__walk, &walk) == 0) threads_len++;
+    }
+
+    appling_gc__walk(&walk);
+
+    for (size_t i = 0; i < threads_len; i++) {
+      uv_thread_join(&threads[i]);
+    }
+  }
+
+  for (size_t i = 0; i < walk.len; i++) {
+    free(walk.entries[i].path);
+  }
+
+  free(walk.entries);
+
+  uv_cond_destroy(&walk.available);
+  uv_mutex_destroy(&walk.lock);
+
+  if (err < 0) goto done;
+
+  appling_gc__enter_collect();
+
+  for (size_t i = 0; i < stale_len; i++) {
+    log_debug("appling_gc() removing platform version at %s", stale[i].path);
+
+    err = appling_fs__rm(&loop, stale[i].path);
+
+    if (err < 0) {
+      log_debug("appling_gc() could not remove %s: %s", stale[i].path, uv_strerror(err));
+      continue;
+    }
+
+    req->removed++;
+    req->reclaimed += stale[i].size;
+  }
+
+  appling_gc__leave_collect();
+
+  err = 0;
+
+done:
+  free(stale);
+
+  uv_loop_close(&loop);
+
+  req->status = err < 0 ? err : 0;
+}
+
+static void
+appling_gc__on_unlock(appling_lock_t *lock, int status) {
+  appling_gc_t *req = (appling_gc_t *) lock->data;
+
+  if (req->status < 0) status = req->status;
+
+  if (req->cb) req->cb(req, status < 0 ? status : 0);
+}
+
+static void
+appling_gc__on_after_work(uv_work_t *handle, int status) {
+  appling_gc_t *req = (appling_gc_t *) handle->data;
+
+  if (status < 0 && req->status == 0) req->status = status;
+
+  log_debug("appling_gc() removed %zu platform versions, reclaiming %llu bytes", req->removed, (unsigned long long) req->reclaimed);
+
+  int err = appling_unlock(req->loop, &req->lock, appling_gc__on_unlock);
+
+  if (err < 0) appling_gc__on_unlock(&req->lock, err);
+}
+
+static void
+appling_gc__on_lock(appling_lock_t *lock, int status) {
+  int err;
+
+  appling_gc_t *req = (appling_gc_t *) lock->data;
+
+  if (status < 0) {
+    if (req->cb) req->cb(req, status);
+    return;
+  }
+
+  err = uv_queue_work(req->loop, &req->work, appling_gc__on_work, appling_gc__on_after_work);
+
+  if (err < 0) {
+    req->status = err;
+
+    err = appling_unlock(req->loop, &req->lock, appling_gc__on_unlock);
+
+    if (err < 0) appling_gc__on_unlock(&req->lock, err);
+  }
+}
+
+int
+appling_gc(uv_loop_t *loop, appling_gc_t *req, const char *dir, const appling_gc_options_t *options, appling_gc_cb cb) {
+  int err;
+
+  req->loop = loop;
+  req->cb = cb;
+  req->retain = 0;
+  req->removed = 0;
+  req->reclaimed = 0;
+  req->status = 0;
+  req->lock.data = (void *) req;
+  req->work.data = (void *) req;
+
+  if (options) {
+    req->retain = options->retain;
+  }
+
+  if (dir && path_is_absolute(dir, path_behavior_system)) strcpy(req->dir, dir);
+  else if (dir) {
+    appling_path_t cwd;
+    size_t path_len = sizeof(appling_path_t);
+
+    err = uv_cwd(cwd, &path_len);
+    if (err < 0) return err;
+
+    path_len = sizeof(appling_path_t);
+
+    path_join(
+      (const char *[]) {cwd, dir, NULL},
+      req->dir,
+      &path_len,
+      path_behavior_system
+    );
+  } else {
+    appling_path_t homedir;
+    size_t path_len = sizeof(appling_path_t);
+
+    err = appling_platform__resolve_dir(homedir, &path_len);
+    if (err < 0) return err;
+
+    path_len = sizeof(appling_path_t);
+
+    path_join(
+      (const char *[]) {homedir, appling_platform_dir, NULL},
+      req->dir,
+      &path_len,
+      path_behavior_system
+    );
+  }
+
+  log_debug("appling_gc() collecting platform versions in %s", req->dir);
+
+  return appling_lock(loop, &req->lock, req->dir, appling_gc__on_lock);
+}
@@ -0,0 +1,20 @@
+#ifndef APPLING_GC_H
+#define APPLING_GC_H
+
+#include <uv.h>
+
+// Resolves and garbage collections in the same process exclude each other so
+// that a resolve never observes a platform version that is being removed. Any
+// number of resolves may be in progress at once.
+
+// Enter a resolve, returning 0 if it may go ahead right away. If a collection
+// is in progress, 1 is returned instead and `resume` is initialized on `loop`
+// and signalled once the collection finishes, at which point the resolve has
+// been entered and the handle should be closed.
+int
+appling_gc__enter_resolve(uv_loop_t *loop, uv_async_t *resume, uv_async_cb cb);
+
+void
+appling_gc__leave_resolve(void);
+
+#endif // APPLING_GC_H
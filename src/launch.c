@@ -18,6 +18,8 @@
 
 #include "../include/appling.h"
 
+#include "launcher.h"
+
 static void
 appling__bootstrap_log(const char *tag, const char *detail) {
   const char *log_path = getenv("PEAR_BOOTSTRAP_LOG");
@@ -428,92 +430,28 @@ appling__launch_direct(const appling_platform_t *platform, const appling_app_t *
 }
 #endif
 
-int
-appling_launch(const appling_platform_t *platform, const appling_app_t *app, const appling_link_t *link, const char *name) {
+static int
+appling_launch__entry(appling_session_t *session, const appling_app_t *app, const appling_link_t *link, const char *name) {
   int err;
 
-  appling_path_t path;
-  size_t path_len = sizeof(appling_path_t);
-
-  path_join(
-    (const char *[]) {platform->path, "lib", appling_platform_entry, NULL},
-    path,
-    &path_len,
-    path_behavior_system
-  );
-
-  {
-    appling_path_t runtime;
-    size_t runtime_len = sizeof(appling_path_t);
-    path_join(
-      (const char *[]) {
-        platform->path,
-        "bin",
-#if defined(APPLING_OS_WIN32)
-        "pear-runtime.exe",
-#else
-        "pear-runtime",
-#endif
-        NULL
-      },
-      runtime,
-      &runtime_len,
-      path_behavior_system
-    );
-    uv_fs_t stat_req;
-    int rc = uv_fs_stat(uv_default_loop(), &stat_req, runtime, NULL);
-    if (rc < 0) {
-      char buf[256];
-      snprintf(buf, sizeof(buf), "missing(%d) %s", rc, runtime);
-      appling__bootstrap_log("runtime-missing", buf);
-    } else {
-      appling__bootstrap_log("runtime-ok", runtime);
-    }
-    uv_fs_req_cleanup(&stat_req);
-  }
-
-#if defined(APPLING_OS_WIN32)
-  err = appling__launch_direct(platform, app, link, name);
-  if (err == 0) {
-    return 0;
-  }
-  appling__bootstrap_log("launch-direct-fallback", "using launch.dll");
-#endif
-
-  appling__bootstrap_log("launch-dll", path);
+  appling__bootstrap_log("launch-dll", session->path);
   {
     char buf[512];
-    snprintf(buf, sizeof(buf), "platform=%s", platform->path);
+    snprintf(buf, sizeof(buf), "platform=%s", session->platform.path);
     appling__bootstrap_log("launch-platform", buf);
   }
 
-  uv_lib_t library;
-  err = uv_dlopen(path, &library);
-  if (err < 0) {
-    const char *dlerr = uv_dlerror(&library);
-    char buf[256];
-    snprintf(buf, sizeof(buf), "err=%d %s", err, dlerr ? dlerr : "unknown");
-    appling__bootstrap_log("launch-dlopen", buf);
-    return err;
-  }
-
-  appling_launch_cb launch;
-  err = uv_dlsym(&library, "appling_launch_v0", (void **) &launch);
-  if (err < 0) {
-    uv_dlclose(&library);
-
-    const char *dlerr = uv_dlerror(&library);
-    char buf[256];
-    snprintf(buf, sizeof(buf), "err=%d %s", err, dlerr ? dlerr : "unknown");
-    appling__bootstrap_log("launch-dlsym", buf);
+  appling_launch_cb launch = session->launch;
+  if (launch == NULL) {
+    appling__bootstrap_log("launch-dlsym", "appling_launch_v0 missing");
 
-    return err; // Must exist
+    return UV_ENOENT; // Must exist
   }
 
   appling_launch_info_t info = {
     .version = 1,
-    .path = path,
-    .platform = platform,
+    .path = session->path,
+    .platform = &session->platform,
     .app = app,
     .link = link,
     .name = name,
@@ -542,19 +480,11 @@ appling_launch(const appling_platform_t *platform, const appling_app_t *app, con
   err = -1;
 
 #if defined(APPLING_OS_WIN32)
-  appling_launch_cb launch_v0;
-  int sym_err = uv_dlsym(&library, "appling_launch_v0", (void **) &launch_v0);
-  if (sym_err == 0 && launch_v0 != NULL) {
-    appling_launch_info_t info_v0 = info;
-    info_v0.version = 0;
-    info_v0.name = NULL;
-    appling__bootstrap_log("launch-mode", "v0");
-    err = launch_v0(&info_v0);
-  } else {
-    char buf[128];
-    snprintf(buf, sizeof(buf), "sym err=%d", sym_err);
-    appling__bootstrap_log("launch-v0-missing", buf);
-  }
+  appling_launch_info_t info_v0 = info;
+  info_v0.version = 0;
+  info_v0.name = NULL;
+  appling__bootstrap_log("launch-mode", "v0");
+  err = launch(&info_v0);
 #endif
 
   if (err < 0) {
@@ -562,8 +492,6 @@ appling_launch(const appling_platform_t *platform, const appling_app_t *app, con
     err = launch(&info);
   }
 
-  uv_dlclose(&library);
-
   if (err < 0) {
     char buf[64];
     snprintf(buf, sizeof(buf), "err=%d", err);
@@ -573,3 +501,91 @@ appling_launch(const appling_platform_t *platform, const appling_app_t *app, con
   return err;
 }
 
+static void
+appling_launch__check_runtime(const appling_platform_t *platform) {
+  appling_path_t runtime;
+  size_t runtime_len = sizeof(appling_path_t);
+  path_join(
+    (const char *[]) {
+      platform->path,
+      "bin",
+#if defined(APPLING_OS_WIN32)
+      "pear-runtime.exe",
+#else
+      "pear-runtime",
+#endif
+      NULL
+    },
+    runtime,
+    &runtime_len,
+    path_behavior_system
+  );
+  uv_fs_t stat_req;
+  int rc = uv_fs_stat(uv_default_loop(), &stat_req, runtime, NULL);
+  if (rc < 0) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "missing(%d) %s", rc, runtime);
+    appling__bootstrap_log("runtime-missing", buf);
+  } else {
+    appling__bootstrap_log("runtime-ok", runtime);
+  }
+  uv_fs_req_cleanup(&stat_req);
+}
+
+int
+appling_launch(const appling_platform_t *platform, const appling_app_t *app, const appling_link_t *link, const char *name) {
+  int err;
+
+  appling_launch__check_runtime(platform);
+
+#if defined(APPLING_OS_WIN32)
+  err = appling__launch_direct(platform, app, link, name);
+  if (err == 0) {
+    return 0;
+  }
+  appling__bootstrap_log("launch-direct-fallback", "using launch.dll");
+#endif
+
+  appling_session_t session;
+  err = appling_session_open(&session, platform);
+  if (err < 0) {
+    const char *dlerr = uv_dlerror(&session.library);
+    char buf[256];
+    snprintf(buf, sizeof(buf), "err=%d %s", err, dlerr ? dlerr : "unknown");
+    appling__bootstrap_log("launch-dlopen", buf);
+    return err;
+  }
+
+  err = appling_launch__entry(&session, app, link, name);
+
+  appling_session_close(&session);
+
+  return err;
+}
+
+int
+appling_launch_service(const appling_platform_t *platform, const appling_app_t *app, const appling_link_t *link, const char *name) {
+  int err;
+
+  err = appling_launcher__launch(platform, app, link, name);
+  if (err == 0) return 0;
+
+  return appling_launch(platform, app, link, name);
+}
+
+int
+appling_session_launch(appling_session_t *session, const appling_app_t *app, const appling_link_t *link, const char *name) {
+  int err;
+
+  appling_launch__check_runtime(&session->platform);
+
+#if defined(APPLING_OS_WIN32)
+  err = appling__launch_direct(&session->platform, app, link, name);
+  if (err == 0) {
+    return 0;
+  }
+  appling__bootstrap_log("launch-direct-fallback", "using launch.dll");
+#endif
+
+  return appling_launch__entry(session, app, link, name);
+}
@@ -0,0 +1,317 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // For struct ucred
+#endif
+
+#include <assert.h>
+#include <compact.h>
+#include <log.h>
+#include <path.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utf.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#include "command.h"
+#include "launcher.h"
+#include "platform-dir.h"
+
+#if !defined(APPLING_OS_WIN32)
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+// See `appling_launch_service()` for the messages exchanged with the service.
+//
+// The socket belongs to the user, so it lives in their runtime directory, or
+// failing that in their platform directory, but never in the system store,
+// which other users share. As anyone may still bind a socket at a path that
+// a user can be pointed at, the service is only trusted once it has been found
+// to run as the same user.
+
+#define APPLING_LAUNCHER_ENV     "PEAR_LAUNCHER_SOCKET"
+#define APPLING_LAUNCHER_SOCKET  "launcher.sock"
+#define APPLING_LAUNCHER_RUNTIME "pear-launcher.sock"
+#define APPLING_LAUNCHER_TIMEOUT 1000
+
+// The shortest limit on the path of a UNIX socket, which is that of macOS.
+#define APPLING_LAUNCHER_SOCKET_MAX 104
+
+typedef struct {
+  uv_pipe_t pipe;
+  uv_connect_t connect;
+  uv_write_t write;
+  uv_timer_t timer;
+
+  uv_buf_t message;
+
+  char reply;
+
+  int status;
+} appling_launcher__client_t;
+
+static int
+appling_launcher__socket(appling_path_t path) {
+#if defined(APPLING_OS_WIN32)
+  return UV_ENOTSUP;
+#else
+  int err;
+
+  const char *socket = getenv(APPLING_LAUNCHER_ENV);
+  const char *runtime = getenv("XDG_RUNTIME_DIR");
+
+  size_t path_len = sizeof(appling_path_t);
+
+  if (socket && socket[0]) {
+    if (strlen(socket) >= sizeof(appling_path_t)) return UV_ENAMETOOLONG;
+
+    strcpy(path, socket);
+  } else if (runtime && runtime[0]) {
+    err = path_join(
+      (const char *[]) {runtime, APPLING_LAUNCHER_RUNTIME, NULL},
+      path,
+      &path_len,
+      path_behavior_system
+    );
+    if (err < 0) return UV_ENAMETOOLONG;
+  } else {
+    appling_path_t homedir;
+    size_t homedir_len = sizeof(appling_path_t);
+
+    err = appling_platform__resolve_dir(homedir, &homedir_len);
+    if (err < 0) return err;
+
+    err = path_join(
+      (const char *[]) {homedir, appling_platform_dir, APPLING_LAUNCHER_SOCKET, NULL},
+      path,
+      &path_len,
+      path_behavior_system
+    );
+    if (err < 0) return UV_ENAMETOOLONG;
+  }
+
+  if (strlen(path) >= APPLING_LAUNCHER_SOCKET_MAX) return UV_ENAMETOOLONG;
+
+  return 0;
+#endif
+}
+
+// Check that the service at the other end of the socket runs as the current
+// user.
+static int
+appling_launcher__check_peer(uv_pipe_t *pipe) {
+#if defined(APPLING_OS_WIN32)
+  return UV_ENOTSUP;
+#else
+  int err;
+
+  uv_os_fd_t fd;
+  err = uv_fileno((uv_handle_t *) pipe, &fd);
+  if (err < 0) return err;
+
+  uid_t uid;
+
+#if defined(__linux__)
+  struct ucred cred;
+  socklen_t cred_len = sizeof(cred);
+
+  err = getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len);
+  if (err < 0) return uv_translate_sys_error(errno);
+
+  uid = cred.uid;
+#else
+  gid_t gid;
+
+  err = getpeereid(fd, &uid, &gid);
+  if (err < 0) return uv_translate_sys_error(errno);
+#endif
+
+  if (uid != getuid()) return UV_EPERM;
+
+  return 0;
+#endif
+}
+
+static void
+appling_launcher__encode(compact_state_t *state, const utf8_string_view_t fields[3], const appling_platform_t *platform, bool preencode) {
+  if (preencode) {
+    for (size_t i = 0; i < 3; i++) compact_preencode_utf8(state, fields[i]);
+
+    compact_preencode_fixed32(state, platform->key);
+    compact_preencode_uint(state, platform->length);
+    compact_preencode_uint(state, platform->fork);
+  } else {
+    for (size_t i = 0; i < 3; i++) compact_encode_utf8(state, fields[i]);
+
+    compact_encode_fixed32(state, platform->key);
+    compact_encode_uint(state, platform->length);
+    compact_encode_uint(state, platform->fork);
+  }
+}
+
+static int
+appling_launcher__message(const appling_platform_t *platform, const appling_app_t *app, const appling_link_t *link, const char *name, uv_buf_t *buf) {
+  appling_command_link_t target;
+  appling_command__link(link, target);
+
+  appling_path_t appling;
+  appling_command__appling(app, appling);
+
+  if (name == NULL) name = "";
+
+  utf8_string_view_t fields[3] = {
+    {.data = (const utf8_t *) target, .len = strlen(target)},
+    {.data = (const utf8_t *) appling, .len = strlen(appling)},
+    {.data = (const utf8_t *) name, .len = strlen(name)},
+  };
+
+  compact_state_t message = {0, 0, NULL};
+
+  appling_launcher__encode(&message, fields, platform, true);
+
+  compact_state_t state = {0, 0, NULL};
+
+  compact_preencode_uint(&state, message.end);
+
+  state.end += message.end;
+  state.buffer = malloc(state.end);
+
+  if (state.buffer == NULL) return UV_ENOMEM;
+
+  compact_encode_uint(&state, message.end);
+
+  appling_launcher__encode(&state, fields, platform, false);
+
+  *buf = uv_buf_init((char *) state.buffer, state.end);
+
+  return 0;
+}
+
+static void
+appling_launcher__close(appling_launcher__client_t *client, int status) {
+  if (uv_is_closing((uv_handle_t *) &client->pipe)) return;
+
+  client->status = status;
+
+  uv_close((uv_handle_t *) &client->pipe, NULL);
+  uv_close((uv_handle_t *) &client->timer, NULL);
+}
+
+static void
+appling_launcher__on_alloc(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
+  appling_launcher__client_t *client = (appling_launcher__client_t *) handle->data;
+
+  *buf = uv_buf_init(&client->reply, 1);
+}
+
+static void
+appling_launcher__on_read(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf) {
+  appling_launcher__client_t *client = (appling_launcher__client_t *) stream->data;
+
+  if (nread == 0) return;
+
+  if (nread < 0) appling_launcher__close(client, (int) nread);
+  else appling_launcher__close(client, client->reply == 0 ? 0 : UV_ECONNREFUSED);
+}
+
+static void
+appling_launcher__on_write(uv_write_t *req, int status) {
+  appling_launcher__client_t *client = (appling_launcher__client_t *) req->data;
+
+  if (status < 0) {
+    appling_launcher__close(client, status);
+    return;
+  }
+
+  status = uv_read_start((uv_stream_t *) &client->pipe, appling_launcher__on_alloc, appling_launcher__on_read);
+
+  if (status < 0) appling_launcher__close(client, status);
+}
+
+static void
+appling_launcher__on_connect(uv_connect_t *req, int status) {
+  appling_launcher__client_t *client = (appling_launcher__client_t *) req->data;
+
+  if (status < 0) {
+    appling_launcher__close(client, status);
+    return;
+  }
+
+  status = appling_launcher__check_peer(&client->pipe);
+
+  if (status < 0) {
+    appling_launcher__close(client, status);
+    return;
+  }
+
+  status = uv_write(&client->write, (uv_stream_t *) &client->pipe, &client->message, 1, appling_launcher__on_write);
+
+  if (status < 0) appling_launcher__close(client, status);
+}
+
+static void
+appling_launcher__on_timeout(uv_timer_t *timer) {
+  appling_launcher__client_t *client = (appling_launcher__client_t *) timer->data;
+
+  appling_launcher__close(client, UV_ETIMEDOUT);
+}
+
+int
+appling_launcher__launch(const appling_platform_t *platform, const appling_app_t *app, const appling_link_t *link, const char *name) {
+  int err;
+
+  appling_path_t path;
+  err = appling_launcher__socket(path);
+  if (err < 0) return err;
+
+  appling_launcher__client_t client;
+
+  err = appling_launcher__message(platform, app, link, name, &client.message);
+  if (err < 0) return err;
+
+  // The launch is synchronous, so the exchange runs on a loop of its own
+  // rather than on any loop of the caller.
+  uv_loop_t loop;
+  err = uv_loop_init(&loop);
+
+  if (err < 0) {
+    free(client.message.base);
+
+    return err;
+  }
+
+  client.status = 0;
+  client.pipe.data = (void *) &client;
+  client.connect.data = (void *) &client;
+  client.write.data = (void *) &client;
+  client.timer.data = (void *) &client;
+
+  err = uv_pipe_init(&loop, &client.pipe, 0);
+  assert(err == 0);
+
+  err = uv_timer_init(&loop, &client.timer);
+  assert(err == 0);
+
+  err = uv_timer_start(&client.timer, appling_launcher__on_timeout, APPLING_LAUNCHER_TIMEOUT, 0);
+  assert(err == 0);
+
+  uv_pipe_connect(&client.connect, &client.pipe, path, appling_launcher__on_connect);
+
+  err = uv_run(&loop, UV_RUN_DEFAULT);
+  assert(err == 0);
+
+  err = uv_loop_close(&loop);
+  assert(err == 0);
+
+  free(client.message.base);
+
+  if (client.status == 0) log_debug("appling_launch_service() handed launch to service at %s", path);
+  else log_debug("appling_launch_service() could not hand launch to service at %s: %s", path, uv_strerror(client.status));
+
+  return client.status;
+}
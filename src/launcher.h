@@ -0,0 +1,16 @@
+#ifndef APPLING_LAUNCHER_H
+#define APPLING_LAUNCHER_H
+
+#include "../include/appling.h"
+
+// An optional launcher service is a runtime started ahead of time that
+// listens on a socket of the user, in `XDG_RUNTIME_DIR` or else their platform
+// directory, or at the path named by the `PEAR_LAUNCHER_SOCKET` environment
+// variable, for applications to launch. A launch handed to a service of the
+// same user skips starting a runtime of its own. Only used when launching
+// through `appling_launch_service()`.
+
+int
+appling_launcher__launch(const appling_platform_t *platform, const appling_app_t *app, const appling_link_t *link, const char *name);
+
+#endif // APPLING_LAUNCHER_H
@@ -1,15 +1,134 @@
-#include <sys/types.h>
-#include <unistd.h>
+#include <stdint.h>
+#include <uv.h>
 
 #include "../../include/appling.h"
 
+static void
+appling_open__on_exit(uv_process_t *handle, int64_t exit_status, int term_signal) {
+  int *status = (int *) handle->data;
+
+  *status = exit_status == 0 && term_signal == 0 ? 0 : -1;
+
+  uv_close((uv_handle_t *) handle, NULL);
+}
+
 int
 appling_open(const appling_app_t *app, const char *argument) {
-  pid_t pid = fork();
+  int err;
+
+  // Without a loop of the caller to reap the application on, it is started in
+  // the background by a shell that exits as soon as it has done so. The
+  // application is then reparented to init, which reaps it, and only the shell
+  // is waited on here. The shell fails if there is no such application.
+  char *argv[] = {
+    "/bin/sh",
+    "-c",
+    "command -v \"$0\" > /dev/null || exit 127; \"$0\" \"$@\" &",
+    (char *) app->path,
+    (char *) argument,
+    NULL,
+  };
+
+  uv_stdio_container_t stdio[3] = {
+    {.flags = UV_IGNORE},
+    {.flags = UV_INHERIT_FD, .data.fd = 1},
+    {.flags = UV_INHERIT_FD, .data.fd = 2},
+  };
+
+  uv_process_options_t options = {
+    .exit_cb = appling_open__on_exit,
+    .file = argv[0],
+    .args = argv,
+    .stdio_count = 3,
+    .stdio = stdio,
+  };
+
+  uv_loop_t loop;
+  err = uv_loop_init(&loop);
+  if (err < 0) return -1;
+
+  int status = -1;
+
+  uv_process_t process;
+  process.data = (void *) &status;
+
+  err = uv_spawn(&loop, &process, &options);
+
+  // The process handle is initialized even if spawning fails, so it must be
+  // closed either way.
+  if (err < 0) uv_close((uv_handle_t *) &process, NULL);
+
+  uv_run(&loop, UV_RUN_DEFAULT);
+
+  uv_loop_close(&loop);
+
+  return status;
+}
+
+static void
+appling_open__on_close(uv_handle_t *handle) {
+  appling_process_t *process = (appling_process_t *) handle->data;
+
+  if (process->cb) process->cb(process, process->status, process->exit_status, process->term_signal);
+}
+
+static void
+appling_open__on_process_exit(uv_process_t *handle, int64_t exit_status, int term_signal) {
+  appling_process_t *process = (appling_process_t *) handle->data;
+
+  process->exit_status = exit_status;
+  process->term_signal = term_signal;
+
+  uv_close((uv_handle_t *) handle, appling_open__on_close);
+}
+
+int
+appling_open_process(uv_loop_t *loop, appling_process_t *process, const appling_app_t *app, const char *argument, appling_process_cb cb) {
+  int err;
+
+  process->loop = loop;
+  process->cb = cb;
+  process->pid = 0;
+  process->exit_status = -1;
+  process->term_signal = 0;
+  process->status = 0;
+  process->process.data = (void *) process;
+
+  char *argv[3];
+
+  size_t i = 0;
+
+  argv[i++] = (char *) app->path;
+  if (argument) argv[i++] = (char *) argument;
+  argv[i] = NULL;
+
+  uv_stdio_container_t stdio[3] = {
+    {.flags = UV_IGNORE},
+    {.flags = UV_INHERIT_FD, .data.fd = 1},
+    {.flags = UV_INHERIT_FD, .data.fd = 2},
+  };
+
+  uv_process_options_t options = {
+    .exit_cb = appling_open__on_process_exit,
+    .file = argv[0],
+    .args = argv,
+    .stdio_count = 3,
+    .stdio = stdio,
+  };
+
+  err = uv_spawn(loop, &process->process, &options);
+
+  if (err < 0) {
+    // Report the failure through the callback once the handle has closed, as
+    // with any other outcome.
+    process->status = err;
+
+    uv_close((uv_handle_t *) &process->process, appling_open__on_close);
 
-  if (pid < 0) return -1;
+    return 0;
+  }
 
-  if (pid == 0) execlp(app->path, argument, NULL);
+  process->pid = process->process.pid;
 
   return 0;
 }
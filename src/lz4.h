@@ -0,0 +1,78 @@
+#ifndef APPLING_LZ4_H
+#define APPLING_LZ4_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <uv.h>
+
+// Decompressor for the LZ4 block format as produced by compress-bundle.js.
+// On success, `dst_len` is updated to the number of bytes written.
+
+static inline int
+appling_lz4__read_length(const uint8_t *src, size_t src_len, size_t *i, size_t *len) {
+  uint8_t b;
+
+  do {
+    if (*i >= src_len) return UV_EINVAL;
+
+    b = src[(*i)++];
+
+    *len += b;
+  } while (b == 255);
+
+  return 0;
+}
+
+static inline int
+appling_lz4__decompress(const uint8_t *src, size_t src_len, uint8_t *dst, size_t *dst_len) {
+  int err;
+
+  size_t i = 0, o = 0;
+
+  while (i < src_len) {
+    uint8_t token = src[i++];
+
+    size_t len = token >> 4;
+
+    if (len == 15) {
+      err = appling_lz4__read_length(src, src_len, &i, &len);
+      if (err < 0) return err;
+    }
+
+    if (len > src_len - i || len > *dst_len - o) return UV_EINVAL;
+
+    memcpy(&dst[o], &src[i], len);
+
+    i += len;
+    o += len;
+
+    if (i == src_len) break; // The last sequence only has literals
+
+    if (src_len - i < 2) return UV_EINVAL;
+
+    size_t offset = src[i] | src[i + 1] << 8;
+
+    i += 2;
+
+    if (offset == 0 || offset > o) return UV_EINVAL;
+
+    len = (token & 15) + 4;
+
+    if ((token & 15) == 15) {
+      err = appling_lz4__read_length(src, src_len, &i, &len);
+      if (err < 0) return err;
+    }
+
+    if (len > *dst_len - o) return UV_EINVAL;
+
+    // Matches may overlap their own output, so copy byte by byte.
+    for (size_t end = o + len; o < end; o++) dst[o] = dst[o - offset];
+  }
+
+  *dst_len = o;
+
+  return 0;
+}
+
+#endif // APPLING_LZ4_H
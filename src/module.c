@@ -0,0 +1,94 @@
+#include <assert.h>
+#include <log.h>
+#include <path.h>
+#include <stdbool.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#include "module.h"
+
+// The runtime used for bootstrapping and updating the platform, comprising
+// bare, its addons, and the bundles, is built as a separate module that is
+// only loaded once actually needed. It is loaded on first use and never
+// unloaded, as the threads it starts may outlive any single request.
+
+static uv_once_t appling_module__guard = UV_ONCE_INIT;
+
+static uv_mutex_t appling_module__lock;
+
+static uv_lib_t appling_module__library;
+
+static bool appling_module__loaded = false;
+
+static void
+appling_module__on_init(void) {
+  int err;
+
+  err = uv_mutex_init(&appling_module__lock);
+  assert(err == 0);
+}
+
+int
+appling_module__load(const char *module, const char *name, void **result) {
+  int err = 0;
+
+  uv_once(&appling_module__guard, appling_module__on_init);
+
+  uv_mutex_lock(&appling_module__lock);
+
+  if (appling_module__loaded) goto load;
+
+  appling_path_t path;
+
+  if (module) strcpy(path, module);
+  else {
+    appling_path_t exe;
+    size_t path_len = sizeof(appling_path_t);
+
+    err = uv_exepath(exe, &path_len);
+    if (err < 0) goto done;
+
+    while (path_len > 0 && exe[path_len - 1] != '/' && exe[path_len - 1] != '\\') path_len--;
+
+    exe[path_len] = '\0'; // Strip the executable name
+
+    path_len = sizeof(appling_path_t);
+
+    path_join(
+      (const char *[]) {exe, appling_bootstrap_module, NULL},
+      path,
+      &path_len,
+      path_behavior_system
+    );
+  }
+
+  err = uv_dlopen(path, &appling_module__library);
+
+  if (err < 0) {
+    log_debug("appling_module__load() could not load %s: %s", path, uv_dlerror(&appling_module__library));
+
+    uv_dlclose(&appling_module__library);
+
+    err = UV_ENOENT;
+
+    goto done;
+  }
+
+  appling_module__loaded = true;
+
+load:
+  err = uv_dlsym(&appling_module__library, name, result);
+
+  if (err < 0) {
+    log_debug("appling_module__load() could not find %s", name);
+
+    err = UV_ENOSYS;
+  }
+
+done:
+  uv_mutex_unlock(&appling_module__lock);
+
+  return err;
+}
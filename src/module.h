@@ -0,0 +1,7 @@
+#ifndef APPLING_MODULE_H
+#define APPLING_MODULE_H
+
+int
+appling_module__load(const char *module, const char *name, void **result);
+
+#endif // APPLING_MODULE_H
@@ -70,6 +70,46 @@ appling_platform__resolve_dir(appling_path_t out, size_t *out_len) {
   return uv_os_homedir(out, out_len);
 }
 
+// The read-only, system-wide store that an administrator may populate for all
+// users of the machine.
+static inline int
+appling_platform__resolve_system_dir(appling_path_t out, size_t *out_len) {
+#ifdef _WIN32
+  const char *program = getenv("PROGRAMDATA");
+  if (program == NULL || program[0] == '\0') return UV_ENOENT;
+
+  return path_join(
+    (const char *[]) {program, APPLING_PLATFORM_SYSTEM_DIR, NULL},
+    out,
+    out_len,
+    path_behavior_system
+  );
+#else
+  size_t len = strlen(APPLING_PLATFORM_SYSTEM_DIR);
+  if (len >= *out_len) return UV_ENOBUFS;
+
+  memcpy(out, APPLING_PLATFORM_SYSTEM_DIR, len + 1);
+
+  *out_len = len;
+
+  return 0;
+#endif
+}
+
+// The directory holding a resolved platform, which lives at
+// <dir>/by-dkey/<dkey>/<n>/by-arch/<target>.
+static inline void
+appling_platform__dir_of(const appling_platform_t *platform, appling_path_t dir) {
+  size_t path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {platform->path, "..", "..", "..", "..", "..", NULL},
+    dir,
+    &path_len,
+    path_behavior_system
+  );
+}
+
 #endif
 
 
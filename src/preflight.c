@@ -9,48 +9,38 @@
 
 #include "../include/appling.h"
 
-static void
-appling_preflight__on_progress(uint64_t downloaded, uint64_t total) {
-  // TODO
-}
+#include "ready-cache.h"
 
 int
 appling_preflight(const appling_platform_t *platform, const appling_link_t *link) {
   int err;
 
-  appling_path_t path;
-  size_t path_len = sizeof(appling_path_t);
+  appling_session_t session;
+  err = appling_session_open(&session, platform);
+  if (err < 0) return err;
 
-  path_join(
-    (const char *[]) {platform->path, "lib", appling_platform_entry, NULL},
-    path,
-    &path_len,
-    path_behavior_system
-  );
+  err = appling_session_preflight(&session, link, NULL);
 
-  uv_lib_t library;
-  err = uv_dlopen(path, &library);
-  if (err < 0) return err;
+  appling_session_close(&session);
+
+  return err;
+}
 
-  appling_preflight_cb preflight;
-  err = uv_dlsym(&library, "appling_preflight_v0", (void **) &preflight);
-  if (err < 0) {
-    uv_dlclose(&library);
+int
+appling_session_preflight(appling_session_t *session, const appling_link_t *link, appling_progress_cb progress) {
+  if (session->preflight == NULL) return 0; // May not exist
 
-    return 0; // May not exist
-  }
+  // Whatever the outcome, the preflight may have changed whether the link is
+  // ready, so have it checked again.
+  appling_ready_cache__remove(&session->platform, link);
 
   appling_preflight_info_t info = {
     .version = 0,
-    .path = path,
-    .platform = platform,
+    .path = session->path,
+    .platform = &session->platform,
     .link = link,
-    .progress = appling_preflight__on_progress,
+    .progress = progress,
   };
 
-  err = preflight(&info);
-
-  uv_dlclose(&library);
-
-  return err;
+  return session->preflight(&info);
 }
@@ -0,0 +1,51 @@
+#ifndef APPLING_PRIORITY_H
+#define APPLING_PRIORITY_H
+
+#include <errno.h>
+#include <uv.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <sys/resource.h>
+#elif defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Lower the CPU and disk I/O priority of the calling thread only. Threads
+// created by the calling thread afterwards inherit the lowered priorities, so
+// threads shared with the rest of the process, such as those of the libuv
+// thread pool, must be started before calling this.
+
+static inline int
+appling_priority__lower(void) {
+#if defined(_WIN32)
+  // Background mode lowers both the CPU and the disk I/O priority.
+  if (!SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN)) {
+    return uv_translate_sys_error(GetLastError());
+  }
+
+  return 0;
+#else
+  int err;
+
+  err = uv_thread_setpriority(uv_thread_self(), UV_THREAD_PRIORITY_LOWEST);
+  if (err < 0) return err;
+
+#if defined(__APPLE__)
+  err = setiopolicy_np(IOPOL_TYPE_DISK, IOPOL_SCOPE_THREAD, IOPOL_THROTTLE);
+  if (err < 0) return uv_translate_sys_error(errno);
+#elif defined(__linux__) && defined(SYS_ioprio_set)
+  // IOPRIO_PRIO_VALUE(IOPRIO_CLASS_IDLE, 0) for IOPRIO_WHO_PROCESS of the
+  // calling thread, which glibc provides no wrapper for. The thread ID is
+  // given rather than 0 so that only the calling thread is affected.
+  err = (int) syscall(SYS_ioprio_set, 1, (int) syscall(SYS_gettid), 3 << 13);
+  if (err < 0) return uv_translate_sys_error(errno);
+#endif
+
+  return 0;
+#endif
+}
+
+#endif // APPLING_PRIORITY_H
@@ -0,0 +1,162 @@
+#ifndef APPLING_PROGRESS_H
+#define APPLING_PROGRESS_H
+
+#include <compact.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+// The runtime reports the progress of a preflight over a pipe inherited as the
+// file descriptor named by the `PEAR_PREFLIGHT_PROGRESS_FD` environment
+// variable. Each record is a compact encoded length followed by a type and its
+// fields, as with the messages of a bootstrap in a child process, so records of
+// unknown types, or with fields added later, are skipped.
+
+#define APPLING_PROGRESS_ENV "PEAR_PREFLIGHT_PROGRESS_FD"
+#define APPLING_PROGRESS_FD  3
+
+// A runtime may report far more often than a caller can redraw, so progress
+// is forwarded at most once per interval, in milliseconds, save for the first
+// and the last report.
+#define APPLING_PROGRESS_INTERVAL 100
+
+#define APPLING_PROGRESS_BUFFER_MAX 256
+
+enum {
+  appling_progress__record_progress = 1,
+};
+
+typedef struct {
+  appling_progress_cb cb;
+
+  uint8_t buffer[APPLING_PROGRESS_BUFFER_MAX];
+  size_t buffer_len;
+
+  uint64_t downloaded;
+  uint64_t total;
+  uint64_t reported;
+
+  bool pending;
+  bool invalid;
+} appling_progress_t;
+
+static inline void
+appling_progress__init(appling_progress_t *progress, appling_progress_cb cb) {
+  progress->cb = cb;
+  progress->buffer_len = 0;
+  progress->downloaded = 0;
+  progress->total = 0;
+  progress->reported = 0;
+  progress->pending = false;
+  progress->invalid = false;
+}
+
+static inline void
+appling_progress__report(appling_progress_t *progress, bool force) {
+  if (!progress->pending) return;
+
+  uint64_t now = uv_hrtime();
+
+  bool done = progress->total > 0 && progress->downloaded >= progress->total;
+
+  if (!force && !done && progress->reported != 0 && now - progress->reported < APPLING_PROGRESS_INTERVAL * 1000000ULL) {
+    return;
+  }
+
+  progress->pending = false;
+  progress->reported = now;
+
+  progress->cb(progress->downloaded, progress->total);
+}
+
+static inline void
+appling_progress__on_record(appling_progress_t *progress, compact_state_t *state) {
+  int err;
+
+  uintmax_t type;
+  err = compact_decode_uint(state, &type);
+  if (err < 0) return;
+
+  switch (type) {
+  case appling_progress__record_progress: {
+    uintmax_t downloaded, total;
+
+    err = compact_decode_uint(state, &downloaded);
+    if (err < 0) return;
+
+    err = compact_decode_uint(state, &total);
+    if (err < 0) return;
+
+    progress->downloaded = downloaded;
+    progress->total = total;
+    progress->pending = true;
+
+    appling_progress__report(progress, false);
+    break;
+  }
+  }
+}
+
+// Decode as many whole records as have been received, keeping the rest for
+// the next read.
+static inline void
+appling_progress__decode(appling_progress_t *progress) {
+  int err;
+
+  compact_state_t state = {0, progress->buffer_len, progress->buffer};
+
+  while (state.start < state.end) {
+    size_t start = state.start;
+
+    uintmax_t len;
+    err = compact_decode_uint(&state, &len);
+
+    if (err < 0 || state.end - state.start < len) {
+      state.start = start; // Wait for the rest of the record
+      break;
+    }
+
+    compact_state_t record = {state.start, state.start + len, state.buffer};
+
+    appling_progress__on_record(progress, &record);
+
+    state.start += len;
+  }
+
+  progress->buffer_len -= state.start;
+
+  memmove(progress->buffer, progress->buffer + state.start, progress->buffer_len);
+
+  // A record that can never fit the buffer means the runtime is speaking
+  // something else entirely, so stop listening rather than guess.
+  if (progress->buffer_len == APPLING_PROGRESS_BUFFER_MAX) progress->invalid = true;
+}
+
+static inline void
+appling_progress__push(appling_progress_t *progress, const uint8_t *data, size_t len) {
+  while (len > 0 && !progress->invalid) {
+    size_t n = APPLING_PROGRESS_BUFFER_MAX - progress->buffer_len;
+
+    if (n > len) n = len;
+
+    memcpy(progress->buffer + progress->buffer_len, data, n);
+
+    progress->buffer_len += n;
+
+    data += n;
+    len -= n;
+
+    appling_progress__decode(progress);
+  }
+}
+
+// Forward the last progress received, if it was held back by the interval.
+static inline void
+appling_progress__flush(appling_progress_t *progress) {
+  appling_progress__report(progress, true);
+}
+
+#endif // APPLING_PROGRESS_H
@@ -0,0 +1,334 @@
+#include <compact.h>
+#include <log.h>
+#include <path.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utf.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#include "fs-sync.h"
+#include "platform-dir.h"
+#include "ready-cache.h"
+
+// The cache is a sequence of compact encoded entries, each holding the id and
+// data of a link followed by the key, length, and fork of the platform it was
+// found to be ready against. The file is small, so it is read whole and
+// replaced whole.
+
+#define APPLING_READY_CACHE_MAX     256
+#define APPLING_READY_CACHE_LEN_MAX (1024 * 1024)
+
+typedef struct {
+  utf8_string_view_t id;
+  utf8_string_view_t data;
+  appling_key_t key;
+  uintmax_t length;
+  uintmax_t fork;
+} appling_ready_cache__entry_t;
+
+static uv_once_t appling_ready_cache__guard = UV_ONCE_INIT;
+
+static uv_mutex_t appling_ready_cache__lock;
+
+// The number of writes made by the process so far, which names the temporary
+// file of each write apart from those of other threads.
+static unsigned int appling_ready_cache__writes = 0;
+
+static void
+appling_ready_cache__init(void) {
+  int err;
+
+  err = uv_mutex_init(&appling_ready_cache__lock);
+  if (err < 0) abort();
+}
+
+static void
+appling_ready_cache__path(const appling_platform_t *platform, appling_path_t path) {
+  appling_path_t dir;
+  appling_platform__dir_of(platform, dir);
+
+  size_t path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {dir, "ready", NULL},
+    path,
+    &path_len,
+    path_behavior_system
+  );
+}
+
+static int
+appling_ready_cache__next(compact_state_t *state, appling_ready_cache__entry_t *entry) {
+  int err;
+
+  err = compact_decode_utf8(state, &entry->id);
+  if (err < 0) return err;
+
+  err = compact_decode_utf8(state, &entry->data);
+  if (err < 0) return err;
+
+  err = compact_decode_fixed32(state, entry->key);
+  if (err < 0) return err;
+
+  err = compact_decode_uint(state, &entry->length);
+  if (err < 0) return err;
+
+  err = compact_decode_uint(state, &entry->fork);
+  if (err < 0) return err;
+
+  return 0;
+}
+
+static bool
+appling_ready_cache__is_platform(const appling_ready_cache__entry_t *entry, const appling_platform_t *platform) {
+  return (
+    memcmp(entry->key, platform->key, APPLING_KEY_LEN) == 0 &&
+    entry->length == platform->length &&
+    entry->fork == platform->fork
+  );
+}
+
+static bool
+appling_ready_cache__is_link(const appling_ready_cache__entry_t *entry, const appling_link_t *link) {
+  return (
+    utf8_string_view_compare_literal(entry->id, (const utf8_t *) link->id, -1) == 0 &&
+    utf8_string_view_compare_literal(entry->data, (const utf8_t *) link->data, -1) == 0
+  );
+}
+
+static void
+appling_ready_cache__encode_entry(compact_state_t *state, const appling_ready_cache__entry_t *entry, bool preencode) {
+  if (preencode) {
+    compact_preencode_utf8(state, entry->id);
+    compact_preencode_utf8(state, entry->data);
+    compact_preencode_fixed32(state, entry->key);
+    compact_preencode_uint(state, entry->length);
+    compact_preencode_uint(state, entry->fork);
+  } else {
+    compact_encode_utf8(state, entry->id);
+    compact_encode_utf8(state, entry->data);
+    compact_encode_fixed32(state, entry->key);
+    compact_encode_uint(state, entry->length);
+    compact_encode_uint(state, entry->fork);
+  }
+}
+
+// Encode the entries of the previous cache that are still of use, that is
+// those of the same platform version other than the link, after the link
+// itself if it is to be added.
+static void
+appling_ready_cache__encode(compact_state_t *state, const uv_buf_t *previous, const appling_platform_t *platform, const appling_link_t *link, bool add, bool preencode) {
+  size_t count = 0;
+
+  if (add) {
+    appling_ready_cache__entry_t entry = {
+      .id = {.data = (const utf8_t *) link->id, .len = strlen(link->id)},
+      .data = {.data = (const utf8_t *) link->data, .len = strlen(link->data)},
+      .length = platform->length,
+      .fork = platform->fork,
+    };
+
+    memcpy(entry.key, platform->key, APPLING_KEY_LEN);
+
+    appling_ready_cache__encode_entry(state, &entry, preencode);
+
+    count++;
+  }
+
+  compact_state_t existing = {0, previous->len, (uint8_t *) previous->base};
+
+  appling_ready_cache__entry_t entry;
+
+  while (count < APPLING_READY_CACHE_MAX && appling_ready_cache__next(&existing, &entry) == 0) {
+    if (!appling_ready_cache__is_platform(&entry, platform)) continue;
+    if (appling_ready_cache__is_link(&entry, link)) continue;
+
+    appling_ready_cache__encode_entry(state, &entry, preencode);
+
+    count++;
+  }
+}
+
+static void
+appling_ready_cache__write(uv_loop_t *loop, const appling_platform_t *platform, const appling_link_t *link, bool add) {
+  int err;
+
+  appling_path_t path;
+  appling_ready_cache__path(platform, path);
+
+  uv_buf_t previous = uv_buf_init(NULL, 0);
+
+  err = appling_fs__read_file(loop, path, APPLING_READY_CACHE_LEN_MAX, &previous);
+
+  // Leave the cache as is if it has nothing to remove.
+  if (err < 0 && !add) return;
+
+  compact_state_t state = {0, 0, NULL};
+
+  appling_ready_cache__encode(&state, &previous, platform, link, add, true);
+
+  uv_fs_t req;
+
+  if (state.end == 0) {
+    free(previous.base);
+
+    uv_fs_unlink(loop, &req, path, NULL);
+    uv_fs_req_cleanup(&req);
+
+    return;
+  }
+
+  state.buffer = malloc(state.end);
+
+  if (state.buffer) {
+    appling_ready_cache__encode(&state, &previous, platform, link, add, false);
+  }
+
+  if (previous.base) free(previous.base);
+
+  if (state.buffer == NULL) return;
+
+  // Replace the cache in one go so that a concurrent reader never sees a
+  // partial file. Concurrent writers may lose each other's entries, which at
+  // worst costs a check.
+  uv_once(&appling_ready_cache__guard, appling_ready_cache__init);
+
+  uv_mutex_lock(&appling_ready_cache__lock);
+
+  unsigned int write = appling_ready_cache__writes++;
+
+  uv_mutex_unlock(&appling_ready_cache__lock);
+
+  char temp[sizeof(appling_path_t) + 32];
+  snprintf(temp, sizeof(temp), "%s.%d.%u", path, (int) uv_os_getpid(), write);
+
+  err = uv_fs_open(loop, &req, temp, UV_FS_O_WRONLY | UV_FS_O_CREAT | UV_FS_O_TRUNC, 0666, NULL);
+  uv_fs_req_cleanup(&req);
+
+  if (err < 0) {
+    // A system-wide platform directory is read-only, so its links are simply
+    // checked each time.
+    log_debug("appling_ready_cache() could not write cache at %s: %s", path, uv_strerror(err));
+
+    free(state.buffer);
+
+    return;
+  }
+
+  uv_file file = err;
+
+  uv_buf_t buf = uv_buf_init((char *) state.buffer, state.end);
+
+  while (buf.len > 0) {
+    err = uv_fs_write(loop, &req, file, &buf, 1, -1, NULL);
+    uv_fs_req_cleanup(&req);
+
+    if (err <= 0) break;
+
+    buf.base += err;
+    buf.len -= err;
+  }
+
+  uv_fs_close(loop, &req, file, NULL);
+  uv_fs_req_cleanup(&req);
+
+  free(state.buffer);
+
+  if (buf.len == 0) err = appling_fs__rename(loop, temp, path);
+
+  if (buf.len > 0 || err < 0) {
+    uv_fs_unlink(loop, &req, temp, NULL);
+    uv_fs_req_cleanup(&req);
+  }
+}
+
+// The cache is used from whichever thread checks a link, such as that of an
+// updater clearing it, so each operation runs its file system requests on a
+// loop of its own rather than on the default loop of the host.
+static void
+appling_ready_cache__update(const appling_platform_t *platform, const appling_link_t *link, bool add) {
+  int err;
+
+  uv_loop_t loop;
+  err = uv_loop_init(&loop);
+  if (err < 0) return;
+
+  appling_ready_cache__write(&loop, platform, link, add);
+
+  uv_loop_close(&loop);
+}
+
+bool
+appling_ready_cache__get(const appling_platform_t *platform, const appling_link_t *link) {
+  int err;
+
+  appling_path_t path;
+  appling_ready_cache__path(platform, path);
+
+  uv_loop_t loop;
+  err = uv_loop_init(&loop);
+  if (err < 0) return false;
+
+  uv_buf_t buf;
+  err = appling_fs__read_file(&loop, path, APPLING_READY_CACHE_LEN_MAX, &buf);
+
+  uv_loop_close(&loop);
+
+  if (err < 0) return false;
+
+  compact_state_t state = {0, buf.len, (uint8_t *) buf.base};
+
+  appling_ready_cache__entry_t entry;
+
+  bool ready = false;
+
+  while (!ready && appling_ready_cache__next(&state, &entry) == 0) {
+    ready = appling_ready_cache__is_platform(&entry, platform) && appling_ready_cache__is_link(&entry, link);
+  }
+
+  free(buf.base);
+
+  return ready;
+}
+
+void
+appling_ready_cache__add(const appling_platform_t *platform, const appling_link_t *link) {
+  appling_ready_cache__update(platform, link, true);
+}
+
+void
+appling_ready_cache__remove(const appling_platform_t *platform, const appling_link_t *link) {
+  if (!appling_ready_cache__get(platform, link)) return;
+
+  appling_ready_cache__update(platform, link, false);
+}
+
+void
+appling_ready_cache__clear(const char *dir) {
+  int err;
+
+  appling_path_t path;
+  size_t path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {dir, "ready", NULL},
+    path,
+    &path_len,
+    path_behavior_system
+  );
+
+  uv_loop_t loop;
+  err = uv_loop_init(&loop);
+  if (err < 0) return;
+
+  uv_fs_t req;
+  uv_fs_unlink(&loop, &req, path, NULL);
+  uv_fs_req_cleanup(&req);
+
+  uv_loop_close(&loop);
+}
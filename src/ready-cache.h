@@ -0,0 +1,25 @@
+#ifndef APPLING_READY_CACHE_H
+#define APPLING_READY_CACHE_H
+
+#include <stdbool.h>
+
+#include "../include/appling.h"
+
+// Links found to be ready are remembered in the platform directory so that
+// later checks of the same link against the same platform version need not
+// start the runtime at all. Only readiness is remembered, as a link that isn't
+// ready is expected to be preflighted before long.
+
+bool
+appling_ready_cache__get(const appling_platform_t *platform, const appling_link_t *link);
+
+void
+appling_ready_cache__add(const appling_platform_t *platform, const appling_link_t *link);
+
+void
+appling_ready_cache__remove(const appling_platform_t *platform, const appling_link_t *link);
+
+void
+appling_ready_cache__clear(const char *dir);
+
+#endif // APPLING_READY_CACHE_H
@@ -9,42 +9,50 @@
 
 #include "../include/appling.h"
 
+#include "ready-cache.h"
+
 int
 appling_ready(const appling_platform_t *platform, const appling_link_t *link) {
   int err;
 
-  appling_path_t path;
-  size_t path_len = sizeof(appling_path_t);
+  // Answer from the cache before paying for loading the platform library.
+  if (appling_ready_cache__get(platform, link)) {
+    log_debug("appling_ready() link %s found ready in cache", link->id);
 
-  path_join(
-    (const char *[]) {platform->path, "lib", appling_platform_entry, NULL},
-    path,
-    &path_len,
-    path_behavior_system
-  );
+    return 1;
+  }
 
-  uv_lib_t library;
-  err = uv_dlopen(path, &library);
+  appling_session_t session;
+  err = appling_session_open(&session, platform);
   if (err < 0) return err;
 
-  appling_ready_cb ready;
-  err = uv_dlsym(&library, "appling_ready_v0", (void **) &ready);
-  if (err < 0) {
-    uv_dlclose(&library);
+  err = appling_session_ready(&session, link);
+
+  appling_session_close(&session);
+
+  return err;
+}
+
+int
+appling_session_ready(appling_session_t *session, const appling_link_t *link) {
+  if (session->ready == NULL) return 1; // May not exist
 
-    return 1; // May not exist
+  if (appling_ready_cache__get(&session->platform, link)) {
+    log_debug("appling_ready() link %s found ready in cache", link->id);
+
+    return 1;
   }
 
   appling_ready_info_t info = {
     .version = 0,
-    .path = path,
-    .platform = platform,
+    .path = session->path,
+    .platform = &session->platform,
     .link = link,
   };
 
-  err = ready(&info);
+  int ready = session->ready(&info);
 
-  uv_dlclose(&library);
+  if (ready == 1) appling_ready_cache__add(&session->platform, link);
 
-  return err;
+  return ready;
 }
@@ -10,6 +10,7 @@
 
 #include "../include/appling.h"
 
+#include "gc.h"
 #include "platform-dir.h"
 
 static void
@@ -32,6 +33,59 @@ appling__bootstrap_log(const char *tag, const char *detail) {
 static void
 appling_resolve__realpath(appling_resolve_t *req);
 
+static inline const char *
+appling_resolve__root(appling_resolve_t *req) {
+  return req->searching_system ? req->system : req->path;
+}
+
+// The platform in the store of the user is only preferred over the one in the
+// system-wide store if it is newer, such as after an update that the system
+// store has yet to receive. Platforms from different keys are not comparable,
+// in which case the one chosen by the user wins.
+static inline bool
+appling_resolve__is_newer(const appling_platform_t *a, const appling_platform_t *b) {
+  if (memcmp(a->key, b->key, APPLING_KEY_LEN) != 0) return true;
+
+  if (a->fork != b->fork) return a->fork > b->fork;
+
+  return a->length > b->length;
+}
+
+static void
+appling_resolve__done(appling_resolve_t *req, int status) {
+  if (req->system[0] == '\0' || strcmp(req->system, req->path) == 0) {
+    appling_gc__leave_resolve();
+
+    if (req->cb) req->cb(req, status);
+    return;
+  }
+
+  if (!req->searching_system) {
+    req->user = *req->platform;
+    req->user_status = status;
+
+    *req->platform = req->requested;
+
+    req->searching_system = true;
+    req->candidate = 0;
+    req->status = 0;
+
+    appling_resolve__realpath(req);
+
+    return;
+  }
+
+  if (req->user_status == 0 && (status < 0 || appling_resolve__is_newer(&req->user, req->platform))) {
+    *req->platform = req->user;
+
+    status = 0;
+  }
+
+  appling_gc__leave_resolve();
+
+  if (req->cb) req->cb(req, status);
+}
+
 static void
 appling_resolve__on_close(fs_close_t *fs_req, int status) {
   appling_resolve_t *req = (appling_resolve_t *) fs_req->data;
@@ -50,12 +104,12 @@ appling_resolve__on_close(fs_close_t *fs_req, int status) {
   if (req->status < 0) status = req->status;
 
   if (status >= 0) {
-    if (req->cb) req->cb(req, 0);
+    appling_resolve__done(req, 0);
   } else {
     size_t i = ++req->candidate;
 
     if (appling_platform_candidates[i]) appling_resolve__realpath(req);
-    else if (req->cb) req->cb(req, status);
+    else appling_resolve__done(req, status);
   }
 }
 
@@ -209,7 +263,7 @@ appling_resolve__on_open(fs_open_t *fs_req, int status, uv_file file) {
       snprintf(buf, sizeof(buf), "status=%d path=%s", status, path);
       appling__bootstrap_log("resolve-open", buf);
     }
-    if (req->cb) req->cb(req, status);
+    appling_resolve__done(req, status);
   }
 }
 
@@ -250,7 +304,7 @@ appling_resolve__on_realpath(fs_realpath_t *fs_req, int status, const char *path
       size_t i = req->candidate;
       if (appling_platform_candidates[i]) {
         path_join(
-          (const char *[]) {req->path, appling_platform_candidates[i], NULL},
+          (const char *[]) {appling_resolve__root(req), appling_platform_candidates[i], NULL},
           candidate_path,
           &candidate_len,
           path_behavior_system
@@ -263,7 +317,7 @@ appling_resolve__on_realpath(fs_realpath_t *fs_req, int status, const char *path
     size_t i = ++req->candidate;
 
     if (appling_platform_candidates[i]) appling_resolve__realpath(req);
-    else if (req->cb) req->cb(req, status);
+    else appling_resolve__done(req, status);
   }
 }
 
@@ -275,7 +329,7 @@ appling_resolve__realpath(appling_resolve_t *req) {
   size_t path_len = sizeof(appling_path_t);
 
   path_join(
-    (const char *[]) {req->path, appling_platform_candidates[i], NULL},
+    (const char *[]) {appling_resolve__root(req), appling_platform_candidates[i], NULL},
     path,
     &path_len,
     path_behavior_system
@@ -292,14 +346,29 @@ appling_resolve__realpath(appling_resolve_t *req) {
   fs_realpath(req->loop, &req->realpath, path, appling_resolve__on_realpath);
 }
 
-int
-appling_resolve(uv_loop_t *loop, appling_resolve_t *req, const char *dir, appling_platform_t *platform, appling_resolve_cb cb) {
+static void
+appling_resolve__on_resume_close(uv_handle_t *handle) {
+  appling_resolve_t *req = (appling_resolve_t *) handle->data;
+
+  appling_resolve__realpath(req);
+}
+
+static void
+appling_resolve__on_resume(uv_async_t *handle) {
+  uv_close((uv_handle_t *) handle, appling_resolve__on_resume_close);
+}
+
+static int
+appling_resolve__start(uv_loop_t *loop, appling_resolve_t *req, const char *dir, const char *system, bool with_system, appling_platform_t *platform, appling_resolve_cb cb) {
   int err;
 
   req->loop = loop;
   req->cb = cb;
   req->platform = platform;
+  req->requested = *platform;
   req->candidate = 0;
+  req->searching_system = false;
+  req->user_status = 0;
   req->status = 0;
   req->realpath.data = (void *) req;
   req->open.data = (void *) req;
@@ -340,9 +409,51 @@ appling_resolve(uv_loop_t *loop, appling_resolve_t *req, const char *dir, applin
     );
   }
 
+  if (!with_system) req->system[0] = '\0';
+  else if (system && path_is_absolute(system, path_behavior_system)) strcpy(req->system, system);
+  else if (system) {
+    appling_path_t cwd;
+    size_t path_len = sizeof(appling_path_t);
+
+    err = uv_cwd(cwd, &path_len);
+    if (err < 0) return err;
+
+    path_len = sizeof(appling_path_t);
+
+    path_join(
+      (const char *[]) {cwd, system, NULL},
+      req->system,
+      &path_len,
+      path_behavior_system
+    );
+  } else {
+    size_t path_len = sizeof(appling_path_t);
+
+    err = appling_platform__resolve_system_dir(req->system, &path_len);
+    if (err < 0) req->system[0] = '\0'; // No system-wide store on this machine
+  }
+
   appling__bootstrap_log("resolve-root", req->path);
 
-  appling_resolve__realpath(req);
+  if (req->system[0] != '\0') appling__bootstrap_log("resolve-system", req->system);
+
+  req->resume.data = (void *) req;
+
+  err = appling_gc__enter_resolve(loop, &req->resume, appling_resolve__on_resume);
+  if (err < 0) return err;
+
+  // Otherwise the resolve is resumed once the collection in progress is done.
+  if (err == 0) appling_resolve__realpath(req);
 
   return 0;
 }
+
+int
+appling_resolve(uv_loop_t *loop, appling_resolve_t *req, const char *dir, appling_platform_t *platform, appling_resolve_cb cb) {
+  return appling_resolve__start(loop, req, dir, NULL, dir == NULL, platform, cb);
+}
+
+int
+appling_resolve_with_system(uv_loop_t *loop, appling_resolve_t *req, const char *dir, const char *system, appling_platform_t *platform, appling_resolve_cb cb) {
+  return appling_resolve__start(loop, req, dir, system, true, platform, cb);
+}
@@ -0,0 +1,168 @@
+#include <assert.h>
+#include <log.h>
+#include <path.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#include "command.h"
+
+static void
+appling_run__on_close(uv_handle_t *handle) {
+  appling_run_t *req = (appling_run_t *) handle->data;
+
+  if (--req->pending > 0) return;
+
+  uint64_t duration = uv_hrtime() - req->start;
+
+  if (req->cb) req->cb(req, req->status, req->exit_status, duration);
+}
+
+static void
+appling_run__close(appling_run_t *req) {
+  uv_close((uv_handle_t *) &req->timer, appling_run__on_close);
+
+  if (req->spawned) uv_close((uv_handle_t *) &req->process, appling_run__on_close);
+}
+
+static void
+appling_run__on_exit(uv_process_t *process, int64_t exit_status, int term_signal) {
+  appling_run_t *req = (appling_run_t *) process->data;
+
+  log_debug("appling_run() runtime exited with status %lld and signal %d", (long long) exit_status, term_signal);
+
+  uv_timer_stop(&req->timer);
+
+  req->exit_status = exit_status;
+
+  // A runtime that was killed for missing its deadline is reported as timed
+  // out, and one that was otherwise killed as having failed.
+  if (req->timed_out) req->status = UV_ETIMEDOUT;
+  else if (term_signal) req->status = UV_ECANCELED;
+
+  appling_run__close(req);
+}
+
+static void
+appling_run__on_timeout(uv_timer_t *timer) {
+  appling_run_t *req = (appling_run_t *) timer->data;
+
+  log_debug("appling_run() runtime missed its deadline of %llu ms", (unsigned long long) req->timeout);
+
+  req->timed_out = true;
+
+  uv_process_kill(&req->process, SIGKILL);
+}
+
+static int
+appling_run__spawn(uv_loop_t *loop, appling_run_t *req, char *argv[], uint64_t timeout, appling_run_cb cb) {
+  int err;
+
+  req->loop = loop;
+  req->cb = cb;
+  req->start = uv_hrtime();
+  req->timeout = timeout;
+  req->exit_status = -1;
+  req->status = 0;
+  req->pending = 1;
+  req->spawned = false;
+  req->timed_out = false;
+  req->process.data = (void *) req;
+  req->timer.data = (void *) req;
+
+  err = uv_timer_init(loop, &req->timer);
+  if (err < 0) return err;
+
+  uv_stdio_container_t stdio[3] = {
+    {.flags = UV_IGNORE},
+    {.flags = UV_INHERIT_FD, .data.fd = 1},
+    {.flags = UV_INHERIT_FD, .data.fd = 2},
+  };
+
+  uv_process_options_t options = {
+    .exit_cb = appling_run__on_exit,
+    .file = argv[0],
+    .args = argv,
+    .flags = UV_PROCESS_WINDOWS_HIDE,
+    .stdio_count = 3,
+    .stdio = stdio,
+  };
+
+  log_debug("appling_run() spawning runtime at %s", argv[0]);
+
+  err = uv_spawn(loop, &req->process, &options);
+
+  // The process handle is initialized even if spawning fails, so it must be
+  // closed either way.
+  req->spawned = true;
+  req->pending++;
+
+  if (err < 0) {
+    // Report the failure through the callback once the handles have closed,
+    // as with any other outcome.
+    req->status = err;
+
+    appling_run__close(req);
+
+    return 0;
+  }
+
+  if (timeout > 0) {
+    // Count the deadline from the spawn rather than from whenever the loop
+    // last updated its time.
+    uv_update_time(loop);
+
+    err = uv_timer_start(&req->timer, appling_run__on_timeout, timeout, 0);
+    assert(err == 0);
+  }
+
+  return 0;
+}
+
+int
+appling_run_ready(uv_loop_t *loop, appling_run_t *req, const appling_platform_t *platform, const appling_link_t *link, uint64_t timeout, appling_run_cb cb) {
+  appling_path_t file;
+  appling_command__file(platform, file);
+
+  appling_command_link_t target;
+  appling_command__link(link, target);
+
+  char *argv[APPLING_COMMAND_ARGV_MAX];
+  appling_command__ready(file, target, argv);
+
+  return appling_run__spawn(loop, req, argv, timeout, cb);
+}
+
+int
+appling_run_preflight(uv_loop_t *loop, appling_run_t *req, const appling_platform_t *platform, const appling_link_t *link, uint64_t timeout, appling_run_cb cb) {
+  appling_path_t file;
+  appling_command__file(platform, file);
+
+  appling_command_link_t target;
+  appling_command__link(link, target);
+
+  char *argv[APPLING_COMMAND_ARGV_MAX];
+  appling_command__preflight(file, target, argv);
+
+  return appling_run__spawn(loop, req, argv, timeout, cb);
+}
+
+int
+appling_run_launch(uv_loop_t *loop, appling_run_t *req, const appling_platform_t *platform, const appling_app_t *app, const appling_link_t *link, uint64_t timeout, appling_run_cb cb) {
+  appling_path_t file;
+  appling_command__file(platform, file);
+
+  appling_path_t appling;
+  appling_command__appling(app, appling);
+
+  appling_command_link_t target;
+  appling_command__link(link, target);
+
+  char *argv[APPLING_COMMAND_ARGV_MAX];
+  appling_command__launch(file, appling, target, argv);
+
+  return appling_run__spawn(loop, req, argv, timeout, cb);
+}
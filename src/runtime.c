@@ -0,0 +1,47 @@
+#include <assert.h>
+#include <js.h>
+#include <uv.h>
+
+#include "runtime.h"
+
+static uv_once_t appling_runtime__guard = UV_ONCE_INIT;
+
+static uv_loop_t appling_runtime__loop;
+
+static uv_thread_t appling_runtime__thread;
+
+static js_platform_t *appling_runtime__js;
+
+static void
+appling_runtime__on_thread(void *data) {
+  int err;
+
+  err = uv_run(&appling_runtime__loop, UV_RUN_DEFAULT);
+  assert(err == 0);
+}
+
+static void
+appling_runtime__on_init(void) {
+  int err;
+
+  // The JavaScript platform is created on first use and then lives for the
+  // remainder of the process, as it cannot be recreated once destroyed. It is
+  // given a loop of its own, run on a dedicated thread, so that it never keeps
+  // the loop of a bootstrap, an updater, or the caller alive.
+
+  err = uv_loop_init(&appling_runtime__loop);
+  assert(err == 0);
+
+  err = js_create_platform(&appling_runtime__loop, NULL, &appling_runtime__js);
+  assert(err == 0);
+
+  err = uv_thread_create(&appling_runtime__thread, appling_runtime__on_thread, NULL);
+  assert(err == 0);
+}
+
+js_platform_t *
+appling_runtime__platform(void) {
+  uv_once(&appling_runtime__guard, appling_runtime__on_init);
+
+  return appling_runtime__js;
+}
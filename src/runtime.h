@@ -0,0 +1,9 @@
+#ifndef APPLING_RUNTIME_H
+#define APPLING_RUNTIME_H
+
+#include <js.h>
+
+js_platform_t *
+appling_runtime__platform(void);
+
+#endif // APPLING_RUNTIME_H
@@ -0,0 +1,875 @@
+#include <compact.h>
+#include <log.h>
+#include <path.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utf.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#include "blake2b.h"
+#include "fs-sync.h"
+#include "seed.h"
+
+#define APPLING_SEED_BLOCK_LEN 512
+#define APPLING_SEED_CHUNK_LEN 65536
+
+typedef struct {
+  appling_path_t path;
+  uint64_t length;
+  uint64_t fork;
+} appling_seed__version_t;
+
+static ssize_t
+appling_seed__read(uv_loop_t *loop, uv_file file, char *data, size_t len, int64_t offset) {
+  int err;
+
+  size_t read = 0;
+
+  while (read < len) {
+    uv_buf_t buf = uv_buf_init(data + read, (unsigned int) (len - read));
+
+    uv_fs_t req;
+    err = uv_fs_read(loop, &req, file, &buf, 1, offset + read, NULL);
+    uv_fs_req_cleanup(&req);
+
+    if (err < 0) return err;
+    if (err == 0) break;
+
+    read += err;
+  }
+
+  return read;
+}
+
+static int
+appling_seed__write(uv_loop_t *loop, uv_file file, const char *data, size_t len, int64_t offset) {
+  int err;
+
+  size_t written = 0;
+
+  while (written < len) {
+    uv_buf_t buf = uv_buf_init((char *) data + written, (unsigned int) (len - written));
+
+    uv_fs_t req;
+    err = uv_fs_write(loop, &req, file, &buf, 1, offset + written, NULL);
+    uv_fs_req_cleanup(&req);
+
+    if (err < 0) return err;
+
+    written += err;
+  }
+
+  return 0;
+}
+
+static void
+appling_seed__close(uv_loop_t *loop, uv_file file) {
+  uv_fs_t req;
+  uv_fs_close(loop, &req, file, NULL);
+  uv_fs_req_cleanup(&req);
+}
+
+static const char *
+appling_seed__basename(const char *path) {
+  const char *name = path;
+
+  for (const char *p = path; *p; p++) {
+    if (*p == '/' || *p == '\\') name = p + 1;
+  }
+
+  return name;
+}
+
+static void
+appling_seed__dirname(const char *path, appling_path_t result) {
+  strcpy(result, path);
+
+  char *name = (char *) appling_seed__basename(result);
+
+  if (name > result) name[-1] = '\0';
+}
+
+// Seeds are trusted input, so a version is only verified against the key and
+// length recorded in its own checkout file, and not against the contents of
+// the platform it holds.
+static int
+appling_seed__verify(uv_loop_t *loop, const char *dir, const appling_key_t key, uint64_t minimum, appling_seed__version_t *result) {
+  int err;
+
+  appling_path_t path;
+  size_t path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {dir, "checkout", NULL},
+    path,
+    &path_len,
+    path_behavior_system
+  );
+
+  uv_fs_t req;
+  err = uv_fs_open(loop, &req, path, UV_FS_O_RDONLY, 0, NULL);
+  uv_fs_req_cleanup(&req);
+
+  if (err < 0) return err;
+
+  uv_file file = err;
+
+  uint8_t data[256];
+
+  ssize_t len = appling_seed__read(loop, file, (char *) data, sizeof(data), 0);
+
+  appling_seed__close(loop, file);
+
+  if (len < 0) return (int) len;
+
+  compact_state_t state = {0, (size_t) len, data};
+
+  uint8_t checkout_key[APPLING_KEY_LEN];
+  err = compact_decode_fixed32(&state, checkout_key);
+  if (err < 0) return err;
+
+  uintmax_t length;
+  err = compact_decode_uint(&state, &length);
+  if (err < 0) return err;
+
+  uintmax_t fork;
+  err = compact_decode_uint(&state, &fork);
+  if (err < 0) return err;
+
+  if (memcmp(checkout_key, key, APPLING_KEY_LEN) != 0) {
+    log_debug("appling_bootstrap() rejecting seed at %s with mismatched key", dir);
+
+    return UV_EINVAL;
+  }
+
+  if (length < minimum) {
+    log_debug("appling_bootstrap() rejecting seed at %s with length %ju below %llu", dir, length, (unsigned long long) minimum);
+
+    return UV_EINVAL;
+  }
+
+  path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {dir, "by-arch", appling_target, NULL},
+    path,
+    &path_len,
+    path_behavior_system
+  );
+
+  uv_stat_t stat;
+  err = appling_fs__lstat(loop, path, &stat);
+  if (err < 0) return err;
+
+  if (!appling_fs__is_dir(&stat)) return UV_ENOTDIR;
+
+  strcpy(result->path, dir);
+
+  result->length = length;
+  result->fork = fork;
+
+  return 0;
+}
+
+// The versions of a platform are kept at `by-dkey/<dkey>/<n>`, where the
+// discovery key is derived from the key of the platform as done by Hypercore.
+static void
+appling_seed__dkey(const appling_key_t key, char result[APPLING_KEY_LEN * 2 + 1 /* NULL */]) {
+  uint8_t dkey[APPLING_KEY_LEN];
+
+  appling_blake2b__hash(dkey, sizeof(dkey), (const uint8_t *) "hypercore", 9, key, APPLING_KEY_LEN);
+
+  static const char hex[] = "0123456789abcdef";
+
+  for (size_t i = 0; i < APPLING_KEY_LEN; i++) {
+    result[i * 2] = hex[dkey[i] >> 4];
+    result[i * 2 + 1] = hex[dkey[i] & 0xf];
+  }
+
+  result[APPLING_KEY_LEN * 2] = '\0';
+}
+
+static int
+appling_seed__find(uv_loop_t *loop, const char *root, const char *dkey, const appling_key_t key, uint64_t minimum, appling_seed__version_t *result) {
+  int err;
+
+  bool found = false;
+
+  appling_path_t base;
+  size_t path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {root, "by-dkey", dkey, NULL},
+    base,
+    &path_len,
+    path_behavior_system
+  );
+
+  uv_fs_t versions;
+  err = uv_fs_scandir(loop, &versions, base, 0, NULL);
+
+  if (err >= 0) {
+    uv_dirent_t version;
+
+    while (uv_fs_scandir_next(&versions, &version) != UV_EOF) {
+      appling_path_t path;
+      path_len = sizeof(appling_path_t);
+
+      path_join(
+        (const char *[]) {base, version.name, NULL},
+        path,
+        &path_len,
+        path_behavior_system
+      );
+
+      appling_seed__version_t candidate;
+      err = appling_seed__verify(loop, path, key, minimum, &candidate);
+
+      if (err == 0 && (!found || candidate.length > result->length)) {
+        *result = candidate;
+        found = true;
+      }
+    }
+  }
+
+  uv_fs_req_cleanup(&versions);
+
+  if (!found) log_debug("appling_bootstrap() found no matching platform at %s", base);
+
+  return found ? 0 : UV_ENOENT;
+}
+
+static uint64_t
+appling_seed__number(const char *field, size_t len) {
+  uint64_t n = 0;
+
+  // GNU base-256 encoding for values that don't fit the octal field
+  if ((uint8_t) field[0] & 0x80) {
+    for (size_t i = 1; i < len; i++) n = (n << 8) | (uint8_t) field[i];
+
+    return n;
+  }
+
+  for (size_t i = 0; i < len; i++) {
+    char c = field[i];
+
+    if (c >= '0' && c <= '7') n = (n << 3) | (c - '0');
+    else if (c != ' ' || n != 0) break;
+  }
+
+  return n;
+}
+
+static void
+appling_seed__string(const char *field, size_t len, char *result) {
+  size_t i = 0;
+
+  while (i < len && field[i]) i++;
+
+  memcpy(result, field, i);
+
+  result[i] = '\0';
+}
+
+static bool
+appling_seed__is_safe(const char *name) {
+  if (name[0] == '\0' || name[0] == '/' || name[0] == '\\') return false;
+
+  if (strchr(name, ':')) return false;
+
+  const char *p = name;
+
+  while (*p) {
+    size_t len = strcspn(p, "/\\");
+
+    if (len == 2 && p[0] == '.' && p[1] == '.') return false;
+
+    p += len;
+
+    if (*p) p++;
+  }
+
+  return true;
+}
+
+// Walk the components of a relative path, starting at the given depth below
+// the extraction directory, and return the depth it ends up at or -1 if it
+// leaves the extraction directory along the way.
+static int
+appling_seed__depth(const char *path, int depth) {
+  const char *p = path;
+
+  while (*p) {
+    size_t len = strcspn(p, "/\\");
+
+    if (len == 2 && p[0] == '.' && p[1] == '.') depth--;
+    else if (len > 0 && !(len == 1 && p[0] == '.')) depth++;
+
+    if (depth < 0) return -1;
+
+    p += len;
+
+    if (*p) p++;
+  }
+
+  return depth;
+}
+
+// Check that a symbolic link target, resolved relative to the directory of
+// the entry it belongs to, stays within the extraction directory.
+static bool
+appling_seed__is_safe_link(const char *entry, const char *linkname) {
+  if (linkname[0] == '\0' || linkname[0] == '/' || linkname[0] == '\\') return false;
+
+  if (strchr(linkname, ':')) return false;
+
+  int depth = appling_seed__depth(entry, 0) - 1; // The directory of the entry
+
+  if (depth < 0) return false;
+
+  return appling_seed__depth(linkname, depth) >= 0;
+}
+
+// Check whether any of the parent directories of an entry is a symbolic link
+// extracted earlier, in which case the entry could end up outside of the
+// extraction directory despite its name being safe.
+static bool
+appling_seed__is_linked(uv_loop_t *loop, const char *dir, const char *entry) {
+  int err;
+
+  appling_path_t prefix;
+
+  for (const char *p = entry; *p; p++) {
+    if (*p != '/' && *p != '\\') continue;
+
+    memcpy(prefix, entry, p - entry);
+
+    prefix[p - entry] = '\0';
+
+    appling_path_t path;
+    size_t path_len = sizeof(appling_path_t);
+
+    path_join(
+      (const char *[]) {dir, prefix, NULL},
+      path,
+      &path_len,
+      path_behavior_system
+    );
+
+    uv_stat_t stat;
+    err = appling_fs__lstat(loop, path, &stat);
+
+    if (err < 0) return false;
+
+    if (appling_fs__is_link(&stat)) return true;
+  }
+
+  return false;
+}
+
+static void
+appling_seed__on_pax(const char *data, size_t len, char *path, bool *has_path, char *linkpath, bool *has_linkpath) {
+  size_t i = 0;
+
+  while (i < len) {
+    size_t record_len = 0;
+    size_t j = i;
+
+    while (j < len && data[j] >= '0' && data[j] <= '9') {
+      record_len = record_len * 10 + (data[j++] - '0');
+    }
+
+    if (record_len == 0 || i + record_len > len || j >= len || data[j] != ' ') return;
+
+    const char *key = &data[j + 1];
+    const char *end = &data[i + record_len - 1]; // Trailing newline
+    const char *value = memchr(key, '=', end - key);
+
+    if (value) {
+      size_t key_len = value - key;
+      size_t value_len = end - ++value;
+
+      if (value_len < sizeof(appling_path_t)) {
+        if (key_len == 4 && memcmp(key, "path", 4) == 0) {
+          appling_seed__string(value, value_len, path);
+          *has_path = true;
+        } else if (key_len == 8 && memcmp(key, "linkpath", 8) == 0) {
+          appling_seed__string(value, value_len, linkpath);
+          *has_linkpath = true;
+        }
+      }
+    }
+
+    i += record_len;
+  }
+}
+
+static int
+appling_seed__extract(uv_loop_t *loop, const char *archive, const char *dir) {
+  int err;
+
+  uv_fs_t req;
+  err = uv_fs_open(loop, &req, archive, UV_FS_O_RDONLY, 0, NULL);
+  uv_fs_req_cleanup(&req);
+
+  if (err < 0) return err;
+
+  uv_file file = err;
+
+  char *data = malloc(APPLING_SEED_CHUNK_LEN);
+
+  int64_t offset = 0;
+
+  appling_path_t name, linkname;
+
+  bool has_name = false, has_linkname = false;
+
+  for (;;) {
+    char header[APPLING_SEED_BLOCK_LEN];
+
+    ssize_t len = appling_seed__read(loop, file, header, sizeof(header), offset);
+
+    if (len < 0) {
+      err = (int) len;
+      break;
+    }
+
+    if (len < APPLING_SEED_BLOCK_LEN) {
+      err = UV_EINVAL; // Truncated archive
+      break;
+    }
+
+    offset += APPLING_SEED_BLOCK_LEN;
+
+    bool end = true;
+
+    for (size_t i = 0; i < APPLING_SEED_BLOCK_LEN && end; i++) end = header[i] == '\0';
+
+    if (end) {
+      err = 0;
+      break;
+    }
+
+    uint64_t size = appling_seed__number(&header[124], 12);
+
+    int64_t next = offset + (int64_t) ((size + APPLING_SEED_BLOCK_LEN - 1) / APPLING_SEED_BLOCK_LEN * APPLING_SEED_BLOCK_LEN);
+
+    char type = header[156];
+
+    if (type == 'L' || type == 'K' || type == 'x' || type == 'g') {
+      if (size >= APPLING_SEED_CHUNK_LEN) {
+        err = UV_E2BIG;
+        break;
+      }
+
+      len = appling_seed__read(loop, file, data, (size_t) size, offset);
+
+      if (len < (ssize_t) size) {
+        err = len < 0 ? (int) len : UV_EINVAL;
+        break;
+      }
+
+      if (type == 'L' && size < sizeof(appling_path_t)) {
+        appling_seed__string(data, (size_t) size, name);
+        has_name = true;
+      } else if (type == 'K' && size < sizeof(appling_path_t)) {
+        appling_seed__string(data, (size_t) size, linkname);
+        has_linkname = true;
+      } else if (type == 'x') {
+        appling_seed__on_pax(data, (size_t) size, name, &has_name, linkname, &has_linkname);
+      }
+
+      offset = next;
+
+      continue;
+    }
+
+    if (!has_name) {
+      char prefix[155 + 1];
+      appling_seed__string(&header[345], 155, prefix);
+
+      if (memcmp(&header[257], "ustar", 5) == 0 && prefix[0]) {
+        strcpy(name, prefix);
+        strcat(name, "/");
+        appling_seed__string(&header[0], 100, name + strlen(name));
+      } else {
+        appling_seed__string(&header[0], 100, name);
+      }
+    }
+
+    if (!has_linkname) appling_seed__string(&header[157], 100, linkname);
+
+    has_name = has_linkname = false;
+
+    char *entry = name;
+
+    while (entry[0] == '.' && (entry[1] == '/' || entry[1] == '\\')) entry += 2;
+
+    size_t entry_len = strlen(entry);
+
+    while (entry_len > 0 && (entry[entry_len - 1] == '/' || entry[entry_len - 1] == '\\')) {
+      entry[--entry_len] = '\0';
+    }
+
+    if (entry_len == 0 || (entry_len == 1 && entry[0] == '.')) {
+      offset = next;
+      continue;
+    }
+
+    if (!appling_seed__is_safe(entry) || appling_seed__is_linked(loop, dir, entry)) {
+      log_debug("appling_bootstrap() rejecting unsafe seed entry %s", entry);
+
+      err = UV_EINVAL;
+      break;
+    }
+
+    appling_path_t target;
+    size_t path_len = sizeof(appling_path_t);
+
+    path_join(
+      (const char *[]) {dir, entry, NULL},
+      target,
+      &path_len,
+      path_behavior_system
+    );
+
+    appling_path_t parent;
+    appling_seed__dirname(target, parent);
+
+    err = appling_fs__mkdir(loop, parent);
+    if (err < 0) break;
+
+    int mode = (int) (appling_seed__number(&header[100], 8) & 0777);
+
+    switch (type) {
+    case '5':
+      err = appling_fs__mkdir(loop, target);
+      break;
+
+    case '2':
+      if (!appling_seed__is_safe_link(entry, linkname)) {
+        log_debug("appling_bootstrap() rejecting unsafe seed link %s -> %s", entry, linkname);
+
+        err = UV_EINVAL;
+        break;
+      }
+
+      err = uv_fs_symlink(loop, &req, linkname, target, 0, NULL);
+      uv_fs_req_cleanup(&req);
+      break;
+
+    case '1': {
+      if (!appling_seed__is_safe(linkname)) {
+        err = UV_EINVAL;
+        break;
+      }
+
+      appling_path_t source;
+      path_len = sizeof(appling_path_t);
+
+      path_join(
+        (const char *[]) {dir, linkname, NULL},
+        source,
+        &path_len,
+        path_behavior_system
+      );
+
+      err = uv_fs_link(loop, &req, source, target, NULL);
+      uv_fs_req_cleanup(&req);
+      break;
+    }
+
+    case '0':
+    case '7':
+    case '\0': {
+      err = uv_fs_open(loop, &req, target, UV_FS_O_WRONLY | UV_FS_O_CREAT | UV_FS_O_TRUNC, mode ? mode : 0644, NULL);
+      uv_fs_req_cleanup(&req);
+
+      if (err < 0) break;
+
+      uv_file out = err;
+
+      uint64_t remaining = size;
+      int64_t written = 0;
+
+      while (remaining > 0) {
+        size_t chunk = remaining < APPLING_SEED_CHUNK_LEN ? (size_t) remaining : APPLING_SEED_CHUNK_LEN;
+
+        len = appling_seed__read(loop, file, data, chunk, offset + written);
+
+        if (len < (ssize_t) chunk) {
+          err = len < 0 ? (int) len : UV_EINVAL;
+          break;
+        }
+
+        err = appling_seed__write(loop, out, data, chunk, written);
+        if (err < 0) break;
+
+        remaining -= chunk;
+        written += chunk;
+      }
+
+      appling_seed__close(loop, out);
+      break;
+    }
+
+    default:
+      err = 0; // Unsupported entries such as devices are skipped
+    }
+
+    if (err < 0) break;
+
+    offset = next;
+  }
+
+  free(data);
+
+  appling_seed__close(loop, file);
+
+  return err;
+}
+
+static int
+appling_seed__write_checkout(uv_loop_t *loop, const char *dir, const appling_key_t key, uint64_t length, uint64_t fork) {
+  int err;
+
+  utf8_string_view_t os = {
+    .data = (const utf8_t *) APPLING_OS,
+    .len = strlen(APPLING_OS),
+  };
+
+  utf8_string_view_t arch = {
+    .data = (const utf8_t *) APPLING_ARCH,
+    .len = strlen(APPLING_ARCH),
+  };
+
+  uint8_t data[256];
+
+  compact_state_t state = {0, 0, data};
+
+  compact_preencode_fixed32(&state, key);
+  compact_preencode_uint(&state, length);
+  compact_preencode_uint(&state, fork);
+  compact_preencode_utf8(&state, os);
+  compact_preencode_utf8(&state, arch);
+
+  compact_encode_fixed32(&state, key);
+  compact_encode_uint(&state, length);
+  compact_encode_uint(&state, fork);
+  compact_encode_utf8(&state, os);
+  compact_encode_utf8(&state, arch);
+
+  appling_path_t path;
+  size_t path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {dir, "checkout", NULL},
+    path,
+    &path_len,
+    path_behavior_system
+  );
+
+  uv_fs_t req;
+  err = uv_fs_open(loop, &req, path, UV_FS_O_WRONLY | UV_FS_O_CREAT | UV_FS_O_TRUNC, 0666, NULL);
+  uv_fs_req_cleanup(&req);
+
+  if (err < 0) return err;
+
+  uv_file file = err;
+
+  err = appling_seed__write(loop, file, (const char *) data, state.end, 0);
+
+  appling_seed__close(loop, file);
+
+  return err;
+}
+
+static int
+appling_seed__link(uv_loop_t *loop, const char *dir, const char *target) {
+  int err;
+
+  appling_path_t current, tmp;
+  size_t path_len;
+
+  path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {dir, "current", NULL},
+    current,
+    &path_len,
+    path_behavior_system
+  );
+
+  path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {dir, "current.tmp", NULL},
+    tmp,
+    &path_len,
+    path_behavior_system
+  );
+
+  err = appling_fs__rm(loop, tmp);
+  if (err < 0) return err;
+
+  uv_fs_t req;
+
+#if defined(APPLING_OS_WIN32)
+  err = uv_fs_symlink(loop, &req, target, tmp, UV_FS_SYMLINK_JUNCTION, NULL);
+#else
+  err = uv_fs_symlink(loop, &req, target, tmp, 0, NULL);
+#endif
+  uv_fs_req_cleanup(&req);
+
+  if (err < 0) return err;
+
+#if defined(APPLING_OS_WIN32)
+  // Junctions can't be renamed over one another, so remove the previous one
+  // first at the cost of a brief window without a current platform.
+  err = uv_fs_unlink(loop, &req, current, NULL);
+  uv_fs_req_cleanup(&req);
+
+  if (err < 0 && err != UV_ENOENT) return err;
+#endif
+
+  return appling_fs__rename(loop, tmp, current);
+}
+
+int
+appling_seed__install(uv_loop_t *loop, const char *seed, const char *dir, const appling_key_t key, uint64_t length) {
+  int err;
+
+  log_debug("appling_bootstrap() installing platform from seed %s", seed);
+
+  uv_fs_t req;
+  err = uv_fs_stat(loop, &req, seed, NULL);
+
+  uv_stat_t stat = req.statbuf;
+
+  uv_fs_req_cleanup(&req);
+
+  if (err < 0) return err;
+
+  appling_path_t staging;
+  size_t path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {dir, "seed", NULL},
+    staging,
+    &path_len,
+    path_behavior_system
+  );
+
+  err = appling_fs__rm(loop, staging);
+  if (err < 0) return err;
+
+  // The platform is always installed under the discovery key of the key it
+  // was asked for, never under whatever directory the seed happened to keep
+  // it in, so a seed can't place a platform where another key would find it.
+  char dkey[APPLING_KEY_LEN * 2 + 1 /* NULL */];
+  appling_seed__dkey(key, dkey);
+
+  appling_seed__version_t version;
+
+  if (appling_fs__is_dir(&stat)) {
+    // The seed is either a single platform version, as found at
+    // `by-dkey/<dkey>/<n>`, or a platform directory containing one or more.
+    err = appling_seed__verify(loop, seed, key, length, &version);
+
+    if (err < 0) err = appling_seed__find(loop, seed, dkey, key, length, &version);
+
+    if (err < 0) return err;
+
+    appling_path_t base;
+    path_len = sizeof(appling_path_t);
+
+    path_join(
+      (const char *[]) {staging, "by-dkey", dkey, NULL},
+      base,
+      &path_len,
+      path_behavior_system
+    );
+
+    err = appling_fs__mkdir(loop, base);
+    if (err < 0) goto done;
+
+    appling_path_t path;
+    path_len = sizeof(appling_path_t);
+
+    path_join(
+      (const char *[]) {base, appling_seed__basename(version.path), NULL},
+      path,
+      &path_len,
+      path_behavior_system
+    );
+
+    err = appling_fs__copy(loop, version.path, path);
+    if (err < 0) goto done;
+
+    strcpy(version.path, path);
+  } else {
+    // The seed is an archive of a platform directory, such as produced by
+    // `tar -cf platform.tar by-dkey/<dkey>/<n>` from an existing install.
+    err = appling_fs__mkdir(loop, staging);
+    if (err < 0) return err;
+
+    err = appling_seed__extract(loop, seed, staging);
+    if (err < 0) goto done;
+
+    err = appling_seed__find(loop, staging, dkey, key, length, &version);
+    if (err < 0) goto done;
+  }
+
+  appling_path_t base;
+  path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {dir, "by-dkey", dkey, NULL},
+    base,
+    &path_len,
+    path_behavior_system
+  );
+
+  err = appling_fs__mkdir(loop, base);
+  if (err < 0) goto done;
+
+  appling_path_t target;
+  path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {base, appling_seed__basename(version.path), NULL},
+    target,
+    &path_len,
+    path_behavior_system
+  );
+
+  // A version already installed at the target is only kept if its checkout
+  // records exactly the version of the seed. An older or partial install is
+  // replaced, as it would otherwise be labelled as the seeded version.
+  appling_seed__version_t installed;
+  err = appling_seed__verify(loop, target, key, version.length, &installed);
+
+  if (err == 0 && installed.length == version.length && installed.fork == version.fork) {
+    log_debug("appling_bootstrap() reusing installed platform at %s", target);
+  } else {
+    err = appling_fs__rm(loop, target);
+    if (err < 0) goto done;
+
+    err = appling_fs__rename(loop, version.path, target);
+    if (err < 0) goto done;
+
+    err = appling_seed__write_checkout(loop, target, key, version.length, version.fork);
+    if (err < 0) goto done;
+  }
+
+  err = appling_seed__link(loop, dir, target);
+
+done:
+  appling_fs__rm(loop, staging);
+
+  return err;
+}
@@ -0,0 +1,12 @@
+#ifndef APPLING_SEED_H
+#define APPLING_SEED_H
+
+#include <stdint.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+int
+appling_seed__install(uv_loop_t *loop, const char *seed, const char *dir, const appling_key_t key, uint64_t length);
+
+#endif // APPLING_SEED_H
@@ -0,0 +1,52 @@
+#include <log.h>
+#include <path.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+int
+appling_session_open(appling_session_t *session, const appling_platform_t *platform) {
+  int err;
+
+  memcpy(&session->platform, platform, sizeof(appling_platform_t));
+
+  size_t path_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {platform->path, "lib", appling_platform_entry, NULL},
+    session->path,
+    &path_len,
+    path_behavior_system
+  );
+
+  log_debug("appling_session_open() loading entry library at %s", session->path);
+
+  err = uv_dlopen(session->path, &session->library);
+  if (err < 0) return err;
+
+  // Only the launch entry point must exist, which is checked when launching.
+
+  if (uv_dlsym(&session->library, "appling_ready_v0", (void **) &session->ready) < 0) {
+    session->ready = NULL;
+  }
+
+  if (uv_dlsym(&session->library, "appling_preflight_v0", (void **) &session->preflight) < 0) {
+    session->preflight = NULL;
+  }
+
+  if (uv_dlsym(&session->library, "appling_launch_v0", (void **) &session->launch) < 0) {
+    session->launch = NULL;
+  }
+
+  return 0;
+}
+
+void
+appling_session_close(appling_session_t *session) {
+  uv_dlclose(&session->library);
+
+  session->ready = NULL;
+  session->preflight = NULL;
+  session->launch = NULL;
+}
@@ -0,0 +1,455 @@
+#include <assert.h>
+#include <bare.h>
+#include <js.h>
+#include <log.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utf.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#include "dedupe.h"
+#include "priority.h"
+#include "runtime.h"
+#include "updater-runtime.h"
+#include "updater.bundle.h"
+
+typedef struct appling_updater__runtime_s appling_updater__runtime_t;
+
+struct appling_updater__runtime_s {
+  appling_updater_t *updater;
+
+  const appling_updater_host_t *host;
+
+  uv_thread_t thread;
+  uv_loop_t loop;
+  uv_async_t wakeup;
+  uv_mutex_t lock;
+  uv_work_t start;
+
+  js_env_t *env;
+
+  uint64_t length;
+  uint64_t fork;
+  uint64_t deduped;
+
+  int checks;
+
+  bool paused;
+  bool suspended;
+  bool closing;
+};
+
+static js_value_t *
+appling_updater__update(js_env_t *env, js_callback_info_t *info) {
+  int err;
+
+  appling_updater__runtime_t *runtime;
+
+  size_t argc = 2;
+  js_value_t *argv[2];
+
+  err = js_get_callback_info(env, info, &argc, argv, NULL, (void **) &runtime);
+  assert(err == 0);
+
+  assert(argc == 2);
+
+  int64_t length;
+  err = js_get_value_int64(env, argv[0], &length);
+  assert(err == 0);
+
+  int64_t fork;
+  err = js_get_value_int64(env, argv[1], &fork);
+  assert(err == 0);
+
+  runtime->length = (uint64_t) length;
+  runtime->fork = (uint64_t) fork;
+
+  appling_updater_t *updater = runtime->updater;
+
+  if (updater->dedupe) {
+    err = appling_dedupe__run(&runtime->loop, updater->dir, &runtime->deduped);
+
+    if (err < 0) log_debug("appling_updater() could not deduplicate platform: %s", uv_strerror(err));
+  }
+
+  runtime->host->report(updater, 0, runtime->length, runtime->fork, runtime->deduped);
+
+  return NULL;
+}
+
+static js_value_t *
+appling_updater__checked(js_env_t *env, js_callback_info_t *info) {
+  int err;
+
+  appling_updater__runtime_t *runtime;
+
+  size_t argc = 1;
+  js_value_t *argv[1];
+
+  err = js_get_callback_info(env, info, &argc, argv, NULL, (void **) &runtime);
+  assert(err == 0);
+
+  assert(argc == 1);
+
+  int64_t status;
+  err = js_get_value_int64(env, argv[0], &status);
+  assert(err == 0);
+
+  runtime->host->report(runtime->updater, (int) status, runtime->length, runtime->fork, runtime->deduped);
+
+  return NULL;
+}
+
+static js_value_t *
+appling_updater__error(js_env_t *env, js_callback_info_t *info) {
+  int err;
+
+  size_t argc = 1;
+  js_value_t *argv[1];
+
+  err = js_get_callback_info(env, info, &argc, argv, NULL, NULL);
+  assert(err == 0);
+
+  assert(argc == 1);
+
+  // Anything may be thrown, not just errors, so the value is coerced to a
+  // string, falling back to a fixed message if even that throws.
+  utf8_t error[1024] = "unknown error";
+
+  js_value_t *string;
+  err = js_coerce_to_string(env, argv[0], &string);
+
+  if (err < 0) {
+    js_value_t *exception;
+    err = js_get_and_clear_last_exception(env, &exception);
+    assert(err == 0);
+  } else {
+    err = js_get_value_string_utf8(env, string, error, sizeof(error), NULL);
+    assert(err == 0);
+  }
+
+  log_debug("appling_updater_check() failed: %s", (char *) error);
+
+  return NULL;
+}
+
+static void
+appling_updater__call(appling_updater__runtime_t *runtime, const char *name) {
+  int err;
+
+  js_env_t *env = runtime->env;
+
+  js_handle_scope_t *scope;
+  err = js_open_handle_scope(env, &scope);
+  assert(err == 0);
+
+  js_value_t *global;
+  err = js_get_global(env, &global);
+  assert(err == 0);
+
+  js_value_t *exports;
+  err = js_get_named_property(env, global, "Appling", &exports);
+  assert(err == 0);
+
+  js_value_t *fn;
+  err = js_get_named_property(env, exports, name, &fn);
+  assert(err == 0);
+
+  err = js_call_function(env, exports, fn, 0, NULL, NULL);
+
+  if (err < 0) {
+    js_value_t *error;
+    err = js_get_and_clear_last_exception(env, &error);
+    assert(err == 0);
+
+    log_debug("appling_updater() %s threw", name);
+  }
+
+  err = js_close_handle_scope(env, scope);
+  assert(err == 0);
+}
+
+static void
+appling_updater__on_wakeup(uv_async_t *handle) {
+  appling_updater__runtime_t *runtime = (appling_updater__runtime_t *) handle->data;
+
+  if (runtime->env == NULL) return; // Not yet loaded, woken up again once it is
+
+  uv_mutex_lock(&runtime->lock);
+
+  int checks = runtime->checks;
+  bool paused = runtime->paused;
+  bool closing = runtime->closing;
+
+  runtime->checks = 0;
+
+  uv_mutex_unlock(&runtime->lock);
+
+  if (paused != runtime->suspended && !closing) {
+    appling_updater__call(runtime, paused ? "onpause" : "onresume");
+
+    runtime->suspended = paused;
+  }
+
+  // Checks requested while another was already pending are coalesced, as the
+  // outcome of a single check covers them all.
+  if (checks && !closing) appling_updater__call(runtime, "oncheck");
+
+  if (closing) {
+    appling_updater__call(runtime, "onclose");
+
+    uv_close((uv_handle_t *) handle, NULL);
+  }
+}
+
+static void
+appling_updater__on_start(uv_work_t *req) {}
+
+static void
+appling_updater__on_thread(void *data) {
+  int err;
+
+  appling_updater__runtime_t *runtime = (appling_updater__runtime_t *) data;
+
+  appling_updater_t *updater = runtime->updater;
+
+  if (updater->background) {
+    // The libuv thread pool is shared by the whole process and is started by
+    // the first thread to queue work to it, with the priorities of that
+    // thread. Start it before lowering the priorities so that they only apply
+    // to the updater thread, and the threads of its own storage.
+    err = uv_queue_work(&runtime->loop, &runtime->start, appling_updater__on_start, NULL);
+    assert(err == 0);
+
+    err = appling_priority__lower();
+
+    if (err < 0) log_debug("appling_updater() could not lower priority: %s", uv_strerror(err));
+  }
+
+  bare_options_t options = {
+    .version = 0,
+    .memory_limit = updater->memory_limit,
+  };
+
+  js_env_t *env;
+
+  bare_t *bare;
+  err = bare_setup(&runtime->loop, appling_runtime__platform(), &env, 0, NULL, &options, &bare);
+  assert(err == 0);
+
+  js_handle_scope_t *scope;
+  err = js_open_handle_scope(env, &scope);
+  assert(err == 0);
+
+  js_value_t *global;
+  err = js_get_global(env, &global);
+  assert(err == 0);
+
+  js_value_t *exports;
+  err = js_create_object(env, &exports);
+  assert(err == 0);
+
+  err = js_set_named_property(env, global, "Appling", exports);
+  assert(err == 0);
+
+  void *buffer;
+
+  js_value_t *key;
+  err = js_create_arraybuffer(env, sizeof(updater->key), &buffer, &key);
+  assert(err == 0);
+
+  memcpy(buffer, updater->key, sizeof(updater->key));
+
+  err = js_set_named_property(env, exports, "key", key);
+  assert(err == 0);
+
+  js_value_t *directory;
+  err = js_create_string_utf8(env, (utf8_t *) updater->dir, -1, &directory);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "directory", directory);
+  assert(err == 0);
+
+  js_value_t *nodes;
+  err = js_create_string_utf8(env, (utf8_t *) updater->nodes, -1, &nodes);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "nodes", nodes);
+  assert(err == 0);
+
+  js_value_t *length;
+  err = js_create_int64(env, (int64_t) runtime->length, &length);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "length", length);
+  assert(err == 0);
+
+  js_value_t *fork;
+  err = js_create_int64(env, (int64_t) runtime->fork, &fork);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "fork", fork);
+  assert(err == 0);
+
+  js_value_t *download_rate;
+  err = js_create_int64(env, (int64_t) updater->download_rate, &download_rate);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "downloadRate", download_rate);
+  assert(err == 0);
+
+  js_value_t *disk_rate;
+  err = js_create_int64(env, (int64_t) updater->disk_rate, &disk_rate);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "diskRate", disk_rate);
+  assert(err == 0);
+
+  js_value_t *update;
+  err = js_create_function(env, "update", -1, appling_updater__update, (void *) runtime, &update);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "update", update);
+  assert(err == 0);
+
+  js_value_t *checked;
+  err = js_create_function(env, "checked", -1, appling_updater__checked, (void *) runtime, &checked);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "checked", checked);
+  assert(err == 0);
+
+  js_value_t *error;
+  err = js_create_function(env, "error", -1, appling_updater__error, (void *) runtime, &error);
+  assert(err == 0);
+
+  err = js_set_named_property(env, exports, "error", error);
+  assert(err == 0);
+
+  err = js_close_handle_scope(env, scope);
+  assert(err == 0);
+
+  uv_buf_t source = uv_buf_init((char *) updater_bundle, updater_bundle_len);
+
+  err = bare_load(bare, "bare:/updater.bundle", &source, NULL);
+  assert(err == 0);
+
+  runtime->env = env;
+
+  err = uv_async_send(&runtime->wakeup); // Handle requests made while loading
+  assert(err == 0);
+
+  err = bare_run(bare, UV_RUN_DEFAULT);
+  assert(err == 0);
+
+  int exit_code;
+  err = bare_teardown(bare, UV_RUN_DEFAULT, &exit_code);
+  assert(err == 0);
+
+  err = uv_loop_close(&runtime->loop);
+  assert(err == 0);
+
+  uv_mutex_destroy(&runtime->lock);
+
+  const appling_updater_host_t *host = runtime->host;
+
+  free(runtime);
+
+  host->done(updater);
+}
+
+int
+appling_updater_open_v0(appling_updater_t *updater, const appling_updater_host_t *host) {
+  int err;
+
+  appling_updater__runtime_t *runtime = malloc(sizeof(appling_updater__runtime_t));
+  if (runtime == NULL) return UV_ENOMEM;
+
+  runtime->updater = updater;
+  runtime->host = host;
+  runtime->env = NULL;
+  runtime->length = updater->length;
+  runtime->fork = updater->fork;
+  runtime->deduped = 0;
+  runtime->checks = 0;
+  runtime->paused = false;
+  runtime->suspended = false;
+  runtime->closing = false;
+  runtime->wakeup.data = (void *) runtime;
+
+  err = uv_loop_init(&runtime->loop);
+  if (err < 0) goto err_loop;
+
+  err = uv_mutex_init(&runtime->lock);
+  if (err < 0) goto err_lock;
+
+  err = uv_async_init(&runtime->loop, &runtime->wakeup, appling_updater__on_wakeup);
+  if (err < 0) goto err_wakeup;
+
+  updater->runtime = (void *) runtime;
+
+  err = uv_thread_create(&runtime->thread, appling_updater__on_thread, (void *) runtime);
+  if (err < 0) goto err_thread;
+
+  return 0;
+
+err_thread:
+  uv_close((uv_handle_t *) &runtime->wakeup, NULL);
+
+  uv_run(&runtime->loop, UV_RUN_DEFAULT);
+
+  updater->runtime = NULL;
+
+err_wakeup:
+  uv_mutex_destroy(&runtime->lock);
+
+err_lock:
+  uv_loop_close(&runtime->loop);
+
+err_loop:
+  free(runtime);
+
+  return err;
+}
+
+int
+appling_updater_check_v0(appling_updater_t *updater) {
+  appling_updater__runtime_t *runtime = (appling_updater__runtime_t *) updater->runtime;
+
+  uv_mutex_lock(&runtime->lock);
+
+  runtime->checks++;
+
+  uv_mutex_unlock(&runtime->lock);
+
+  return uv_async_send(&runtime->wakeup);
+}
+
+int
+appling_updater_pause_v0(appling_updater_t *updater, bool paused) {
+  appling_updater__runtime_t *runtime = (appling_updater__runtime_t *) updater->runtime;
+
+  uv_mutex_lock(&runtime->lock);
+
+  runtime->paused = paused;
+
+  uv_mutex_unlock(&runtime->lock);
+
+  return uv_async_send(&runtime->wakeup);
+}
+
+int
+appling_updater_close_v0(appling_updater_t *updater) {
+  appling_updater__runtime_t *runtime = (appling_updater__runtime_t *) updater->runtime;
+
+  uv_mutex_lock(&runtime->lock);
+
+  runtime->closing = true;
+
+  uv_mutex_unlock(&runtime->lock);
+
+  return uv_async_send(&runtime->wakeup);
+}
@@ -0,0 +1,36 @@
+#ifndef APPLING_UPDATER_RUNTIME_H
+#define APPLING_UPDATER_RUNTIME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../include/appling.h"
+
+// The updater runtime lives in the bootstrap module alongside the bootstrap
+// runtime. See bootstrap-runtime.h.
+
+typedef struct appling_updater_host_s appling_updater_host_t;
+
+typedef int (*appling_updater_open_cb)(appling_updater_t *updater, const appling_updater_host_t *host);
+typedef int (*appling_updater_check_cb)(appling_updater_t *updater);
+typedef int (*appling_updater_pause_cb)(appling_updater_t *updater, bool paused);
+typedef int (*appling_updater_close_runtime_cb)(appling_updater_t *updater);
+
+struct appling_updater_host_s {
+  void (*report)(appling_updater_t *updater, int status, uint64_t length, uint64_t fork, uint64_t deduped);
+  void (*done)(appling_updater_t *updater);
+};
+
+int
+appling_updater_open_v0(appling_updater_t *updater, const appling_updater_host_t *host);
+
+int
+appling_updater_check_v0(appling_updater_t *updater);
+
+int
+appling_updater_pause_v0(appling_updater_t *updater, bool paused);
+
+int
+appling_updater_close_v0(appling_updater_t *updater);
+
+#endif // APPLING_UPDATER_RUNTIME_H
@@ -0,0 +1,259 @@
+#include <assert.h>
+#include <path.h>
+#include <stdbool.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#include "module.h"
+#include "platform-dir.h"
+#include "ready-cache.h"
+#include "updater-runtime.h"
+
+static appling_updater_check_cb appling_updater__check;
+static appling_updater_pause_cb appling_updater__pause;
+static appling_updater_close_runtime_cb appling_updater__close;
+
+static void
+appling_updater__on_report(appling_updater_t *updater, int status, uint64_t length, uint64_t fork, uint64_t deduped) {
+  int err;
+
+  uv_mutex_lock(&updater->lock);
+
+  bool updated = status == 0 && (length != updater->length || fork != updater->fork);
+
+  updater->status = status;
+  updater->length = length;
+  updater->fork = fork;
+  updater->deduped = deduped;
+  updater->pending = true;
+
+  uv_mutex_unlock(&updater->lock);
+
+  // Links found ready against the previous platform version must be checked
+  // again against the new one.
+  if (updated) appling_ready_cache__clear(updater->dir);
+
+  err = uv_async_send(&updater->signal);
+  assert(err == 0);
+}
+
+static void
+appling_updater__on_done(appling_updater_t *updater) {
+  int err;
+
+  uv_mutex_lock(&updater->lock);
+
+  updater->done = true;
+
+  uv_mutex_unlock(&updater->lock);
+
+  err = uv_async_send(&updater->signal);
+  assert(err == 0);
+}
+
+static const appling_updater_host_t appling_updater__host = {
+  .report = appling_updater__on_report,
+  .done = appling_updater__on_done,
+};
+
+static void
+appling_updater__on_close(uv_handle_t *handle) {
+  appling_updater_t *updater = (appling_updater_t *) handle->data;
+
+  uv_mutex_destroy(&updater->lock);
+
+  if (updater->on_close) updater->on_close(updater);
+}
+
+static void
+appling_updater__on_signal(uv_async_t *handle) {
+  appling_updater_t *updater = (appling_updater_t *) handle->data;
+
+  uv_mutex_lock(&updater->lock);
+
+  bool pending = updater->pending;
+  bool done = updater->done;
+
+  int status = updater->status;
+  uint64_t length = updater->length;
+  uint64_t fork = updater->fork;
+
+  updater->pending = false;
+
+  uv_mutex_unlock(&updater->lock);
+
+  if (pending && updater->cb) updater->cb(updater, status, length, fork);
+
+  if (done) uv_close((uv_handle_t *) handle, appling_updater__on_close);
+}
+
+int
+appling_updater_open(uv_loop_t *loop, appling_updater_t *updater, const appling_key_t key, const char *dir, const appling_updater_options_t *options, appling_updater_cb cb) {
+  int err;
+
+  updater->loop = loop;
+  updater->cb = cb;
+  updater->on_close = NULL;
+  updater->length = 0;
+  updater->fork = 0;
+  updater->memory_limit = 0;
+  updater->download_rate = 0;
+  updater->disk_rate = 0;
+  updater->background = false;
+  updater->dedupe = false;
+  updater->deduped = 0;
+  updater->runtime = NULL;
+  updater->status = 0;
+  updater->pending = false;
+  updater->paused = false;
+  updater->closing = false;
+  updater->done = false;
+  updater->signal.data = (void *) updater;
+
+  updater->module[0] = '\0';
+  updater->nodes[0] = '\0';
+
+  if (options) {
+    updater->length = options->length;
+    updater->fork = options->fork;
+    updater->memory_limit = options->memory_limit;
+    updater->download_rate = options->download_rate;
+    updater->disk_rate = options->disk_rate;
+    updater->background = options->background;
+    updater->dedupe = options->dedupe;
+
+    if (options->nodes) {
+      if (strlen(options->nodes) > APPLING_NODES_MAX) return UV_EINVAL;
+
+      strcpy(updater->nodes, options->nodes);
+    }
+
+    if (options->module && path_is_absolute(options->module, path_behavior_system)) strcpy(updater->module, options->module);
+    else if (options->module) {
+      appling_path_t cwd;
+      size_t path_len = sizeof(appling_path_t);
+
+      err = uv_cwd(cwd, &path_len);
+      if (err < 0) return err;
+
+      path_len = sizeof(appling_path_t);
+
+      path_join(
+        (const char *[]) {cwd, options->module, NULL},
+        updater->module,
+        &path_len,
+        path_behavior_system
+      );
+    }
+  }
+
+  memcpy(updater->key, key, sizeof(appling_key_t));
+
+  if (dir && path_is_absolute(dir, path_behavior_system)) strcpy(updater->dir, dir);
+  else if (dir) {
+    appling_path_t cwd;
+    size_t path_len = sizeof(appling_path_t);
+
+    err = uv_cwd(cwd, &path_len);
+    if (err < 0) return err;
+
+    path_len = sizeof(appling_path_t);
+
+    path_join(
+      (const char *[]) {cwd, dir, NULL},
+      updater->dir,
+      &path_len,
+      path_behavior_system
+    );
+  } else {
+    appling_path_t homedir;
+    size_t path_len = sizeof(appling_path_t);
+
+    err = appling_platform__resolve_dir(homedir, &path_len);
+    if (err < 0) return err;
+
+    path_len = sizeof(appling_path_t);
+
+    path_join(
+      (const char *[]) {homedir, appling_platform_dir, NULL},
+      updater->dir,
+      &path_len,
+      path_behavior_system
+    );
+  }
+
+  const char *module = updater->module[0] ? updater->module : NULL;
+
+  appling_updater_open_cb open;
+  err = appling_module__load(module, "appling_updater_open_v0", (void **) &open);
+  if (err < 0) return err;
+
+  err = appling_module__load(module, "appling_updater_check_v0", (void **) &appling_updater__check);
+  if (err < 0) return err;
+
+  err = appling_module__load(module, "appling_updater_pause_v0", (void **) &appling_updater__pause);
+  if (err < 0) return err;
+
+  err = appling_module__load(module, "appling_updater_close_v0", (void **) &appling_updater__close);
+  if (err < 0) return err;
+
+  err = uv_mutex_init(&updater->lock);
+  if (err < 0) return err;
+
+  err = uv_async_init(loop, &updater->signal, appling_updater__on_signal);
+  if (err < 0) {
+    uv_mutex_destroy(&updater->lock);
+
+    return err;
+  }
+
+  err = open(updater, &appling_updater__host);
+  if (err < 0) {
+    uv_close((uv_handle_t *) &updater->signal, NULL);
+
+    uv_mutex_destroy(&updater->lock);
+  }
+
+  return err;
+}
+
+int
+appling_updater_check(appling_updater_t *updater) {
+  if (updater->closing) return UV_EINVAL;
+
+  return appling_updater__check(updater);
+}
+
+int
+appling_updater_pause(appling_updater_t *updater) {
+  if (updater->closing) return UV_EINVAL;
+
+  if (updater->paused) return 0;
+
+  updater->paused = true;
+
+  return appling_updater__pause(updater, true);
+}
+
+int
+appling_updater_resume(appling_updater_t *updater) {
+  if (updater->closing) return UV_EINVAL;
+
+  if (!updater->paused) return 0;
+
+  updater->paused = false;
+
+  return appling_updater__pause(updater, false);
+}
+
+int
+appling_updater_close(appling_updater_t *updater, appling_updater_close_cb cb) {
+  if (updater->closing) return UV_EINVAL;
+
+  updater->closing = true;
+  updater->on_close = cb;
+
+  return appling_updater__close(updater);
+}
@@ -0,0 +1,205 @@
+const Corestore = require('corestore')
+const Hyperswarm = require('hyperswarm')
+const Hyperdrive = require('hyperdrive')
+const Updater = require('pear-updater')
+const { Transform, pipeline } = require('streamx')
+const path = require('bare-path')
+
+const onerror = (err) => {
+  Appling.error(err instanceof Error ? err.stack : err)
+}
+
+Bare.on('uncaughtException', onerror).on('unhandledRejection', onerror)
+
+const key = Buffer.from(Appling.key)
+
+// A running platform holds the lock on its own store for as long as it runs,
+// so the updater replicates into a store of its own rather than contending for
+// that lock with every application that is open.
+const store = new Corestore(
+  path.join(Appling.directory, 'corestores', 'updater')
+)
+
+// When given DHT bootstrap nodes, such as those of a local testnet, the swarm
+// joins those rather than the public network.
+const bootstrap = Appling.nodes
+  ? Appling.nodes.split(',').map((node) => {
+      const i = node.lastIndexOf(':')
+
+      return { host: node.slice(0, i), port: Number(node.slice(i + 1)) }
+    })
+  : undefined
+
+const swarm = new Hyperswarm({ bootstrap })
+
+const connections = new Set()
+
+// A budget of bytes that may be spent each second, or unlimited when the rate
+// is 0. Waiters are released once the budget has been refilled.
+class Budget {
+  constructor(rate) {
+    this.rate = rate
+    this.available = rate
+    this.waiting = []
+  }
+
+  get exhausted() {
+    return this.rate > 0 && this.available <= 0
+  }
+
+  spend(bytes) {
+    if (this.rate > 0) this.available -= bytes
+  }
+
+  refill() {
+    this.available = Math.min(this.rate, this.available + this.rate)
+
+    if (this.exhausted) return
+
+    for (const resolve of this.waiting.splice(0)) resolve()
+  }
+
+  wait() {
+    if (!this.exhausted) return Promise.resolve()
+
+    return new Promise((resolve) => this.waiting.push(resolve))
+  }
+}
+
+// The network budget is spent on every block downloaded from peers and the
+// disk budget on every block written, both when it is stored and when it is
+// copied into the next platform version.
+const network = new Budget(Appling.downloadRate)
+const disk = new Budget(Appling.diskRate)
+
+// Replication is held back by pausing the connections to peers, either when
+// asked to by the caller or when either budget has been spent, as every
+// downloaded block is also written to storage.
+let paused = false
+
+function held() {
+  return paused || network.exhausted || disk.exhausted
+}
+
+function flow() {
+  for (const connection of connections) {
+    if (held()) connection.pause()
+    else connection.resume()
+  }
+}
+
+swarm.on('connection', (connection) => {
+  connections.add(connection)
+
+  connection.on('close', () => connections.delete(connection))
+
+  store.replicate(connection)
+
+  if (held()) connection.pause()
+})
+
+const refill =
+  network.rate > 0 || disk.rate > 0
+    ? setInterval(() => {
+        network.refill()
+        disk.refill()
+
+        flow()
+      }, 1000)
+    : null
+
+if (refill) refill.unref()
+
+function ondownload(index, byteLength) {
+  network.spend(byteLength)
+  disk.spend(byteLength)
+
+  if (network.exhausted || disk.exhausted) flow()
+}
+
+// pear-updater copies the files of a new version into next by reading them
+// from a checkout of the drive, so the reads are made to wait on the disk
+// budget for the writes they feed.
+const createReadStream = Hyperdrive.prototype.createReadStream
+
+Hyperdrive.prototype.createReadStream = function (...args) {
+  const stream = createReadStream.apply(this, args)
+
+  if (disk.rate === 0) return stream
+
+  return pipeline(
+    stream,
+    new Transform({
+      transform(data, cb) {
+        disk.spend(data.byteLength)
+        disk.wait().then(() => cb(null, data))
+      }
+    })
+  )
+}
+
+const drive = new Hyperdrive(store, key)
+
+drive.core.on('download', ondownload)
+
+const checkout = { key, length: Appling.length, fork: Appling.fork }
+
+const updater = new Updater(drive, {
+  directory: Appling.directory,
+  checkout,
+  lock: false
+})
+
+updater.on('update', (checkout) => Appling.update(checkout.length, checkout.fork))
+
+// The swarm connections and the drive stay open between checks so that each
+// check only has to ask the peers already connected for the latest length.
+const opened = updater.ready().then(async () => {
+  swarm.join(drive.discoveryKey, { server: false, client: true })
+
+  const blobs = await drive.getBlobs()
+
+  if (blobs) blobs.core.on('download', ondownload)
+})
+
+let checking = null
+
+Appling.oncheck = () => {
+  if (checking) return
+
+  checking = opened
+    .then(() => drive.core.update({ wait: true }))
+    .then(() => updater.update())
+    .then(
+      () => Appling.checked(0),
+      (err) => {
+        onerror(err)
+
+        Appling.checked(1)
+      }
+    )
+    .finally(() => {
+      checking = null
+    })
+}
+
+Appling.onpause = () => {
+  paused = true
+  flow()
+}
+
+Appling.onresume = () => {
+  paused = false
+  flow()
+}
+
+Appling.onclose = () => {
+  if (refill) clearInterval(refill)
+
+  opened
+    .catch(() => {})
+    .then(() => updater.close())
+    .then(() => swarm.destroy())
+    .then(() => store.close())
+    .catch(onerror)
+}
@@ -0,0 +1,223 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#define KEY {0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa}
+
+#define DIR      "test/fixtures/batch"
+#define PLATFORM DIR "/by-dkey/aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa/0/by-arch/" APPLING_TARGET
+#define LOG      DIR "/runtime.log"
+
+#define LINKS       6
+#define CONCURRENCY 2
+
+uv_loop_t *loop;
+
+appling_platform_t platform = {
+  .path = PLATFORM,
+  .key = KEY,
+  .length = 123,
+  .fork = 0,
+};
+
+appling_batch_t batch;
+
+appling_link_t links[LINKS];
+
+int results[LINKS];
+
+int batch_called = 0;
+
+static void
+mkdir_p(const char *path) {
+  char dir[512];
+  strcpy(dir, path);
+
+  for (char *c = dir + 1;; c++) {
+    if (*c != '/' && *c != '\0') continue;
+
+    char end = *c;
+
+    *c = '\0';
+
+    uv_fs_t fs;
+    uv_fs_mkdir(loop, &fs, dir, 0777, NULL);
+    uv_fs_req_cleanup(&fs);
+
+    if (end == '\0') break;
+
+    *c = end;
+  }
+}
+
+static void
+unlink_file(const char *path) {
+  uv_fs_t fs;
+  uv_fs_unlink(loop, &fs, path, NULL);
+  uv_fs_req_cleanup(&fs);
+}
+
+// Read and clear the log of the runtimes run since the last call, returning
+// how many were run and the most that ran at once.
+static int
+runtimes(int *max) {
+  int started = 0, running = 0;
+
+  *max = 0;
+
+  FILE *file = fopen(LOG, "rb");
+
+  if (file) {
+    int c;
+
+    while ((c = fgetc(file)) != EOF) {
+      if (c == '+') {
+        started++;
+        running++;
+
+        if (running > *max) *max = running;
+      } else if (c == '-') {
+        running--;
+      }
+    }
+
+    fclose(file);
+  }
+
+  unlink_file(LOG);
+
+  return started;
+}
+
+static void
+on_batch(appling_batch_t *req, int status);
+
+static void
+run_batch(bool preflight) {
+  int err;
+
+  appling_batch_options_t options = {
+    .version = 0,
+    .concurrency = CONCURRENCY,
+    .timeout = 10000,
+  };
+
+  for (int i = 0; i < LINKS; i++) results[i] = 2;
+
+  if (preflight) {
+    err = appling_batch_preflight(loop, &batch, &platform, links, LINKS, results, &options, on_batch);
+  } else {
+    err = appling_batch_ready(loop, &batch, &platform, links, LINKS, results, &options, on_batch);
+  }
+
+  assert(err == 0);
+}
+
+static void
+on_batch(appling_batch_t *req, int status) {
+  assert(status == 0);
+
+  int max;
+  int started = runtimes(&max);
+
+  printf("batch=%d runtimes=%d max=%d\n", batch_called, started, max);
+
+  for (int i = 0; i < LINKS; i++) {
+    printf("links[%d] result=%d\n", i, results[i]);
+  }
+
+  switch (batch_called++) {
+  case 0:
+    // Every link is checked by the runtime, no more than a few at once.
+    for (int i = 0; i < LINKS; i++) assert(results[i] == 1);
+
+    assert(started == LINKS);
+    assert(max == CONCURRENCY);
+
+    run_batch(false);
+    break;
+
+  case 1:
+    // Every link found ready is now in the cache.
+    for (int i = 0; i < LINKS; i++) assert(results[i] == 1);
+
+    assert(started == 0);
+
+    run_batch(true);
+    break;
+
+  case 2:
+    // Every link is preflighted by the runtime, no more than a few at once.
+    for (int i = 0; i < LINKS; i++) assert(results[i] == 0);
+
+    assert(started == LINKS);
+    assert(max == CONCURRENCY);
+
+    run_batch(false);
+    break;
+
+  case 3:
+    // The preflights removed the links from the cache, leaving them to the
+    // runtime again.
+    for (int i = 0; i < LINKS; i++) assert(results[i] == 1);
+
+    assert(started == LINKS);
+    break;
+  }
+}
+
+int
+main() {
+  int err;
+
+  loop = uv_default_loop();
+
+  // Stand in for the runtime with one that finds every link ready and logs
+  // when it runs.
+  appling_path_t runtime;
+  size_t runtime_len = sizeof(appling_path_t);
+
+  err = uv_exepath(runtime, &runtime_len);
+  assert(err == 0);
+
+  *strrchr(runtime, '/') = '\0';
+
+  strcat(runtime, "/fixtures/runtime");
+
+  mkdir_p(PLATFORM "/bin");
+
+  unlink_file(PLATFORM "/bin/pear-runtime");
+
+  uv_fs_t fs;
+  err = uv_fs_copyfile(loop, &fs, runtime, PLATFORM "/bin/pear-runtime", 0, NULL);
+  uv_fs_req_cleanup(&fs);
+  assert(err == 0);
+
+  unlink_file(DIR "/ready");
+  unlink_file(LOG);
+
+  setenv("APPLING_TEST_RUNTIME", "count", 1);
+  setenv("APPLING_TEST_RUNTIME_LOG", LOG, 1);
+
+  for (int i = 0; i < LINKS; i++) {
+    memset(links[i].id, 'b', APPLING_ID_MAX);
+    links[i].id[APPLING_ID_MAX] = '\0';
+    links[i].data[0] = '\0';
+
+    links[i].id[0] = 'a' + i;
+  }
+
+  run_batch(false);
+
+  err = uv_run(loop, UV_RUN_DEFAULT);
+  assert(err == 0);
+
+  assert(batch_called == 4);
+
+  return 0;
+}
@@ -1,6 +1,5 @@
 #include <assert.h>
 #include <fs.h>
-#include <js.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <uv.h>
@@ -13,8 +12,6 @@ fs_unlink_t unlink_req;
 
 appling_bootstrap_t bootstrap_req;
 
-js_platform_t *js;
-
 bool bootstrap_called = false;
 
 static void
@@ -25,8 +22,15 @@ on_bootstrap(appling_bootstrap_t *req, int status) {
 
   assert(status == 0);
 
-  e = js_destroy_platform(js);
+  printf("reused=%llu fetched=%llu\n", (unsigned long long) req->reused, (unsigned long long) req->fetched);
+
+  char timing[256];
+  size_t timing_len = sizeof(timing);
+
+  e = appling_bootstrap_format_timing(&req->timing, timing, &timing_len);
   assert(e == 0);
+
+  printf("%s\n", timing);
 }
 
 static void
@@ -37,7 +41,7 @@ on_unlink(fs_unlink_t *req, int status) {
 
   appling_key_t key = {0x6b, 0x83, 0x74, 0xf1, 0xc0, 0x80, 0x9e, 0xd2, 0x3c, 0xfc, 0x37, 0x1e, 0x87, 0x89, 0x6c, 0x8d, 0x3b, 0xb5, 0x93, 0xf2, 0x45, 0x1d, 0x4d, 0x8d, 0xe8, 0x95, 0xd6, 0x28, 0x94, 0x18, 0x18, 0xdc};
 
-  e = appling_bootstrap(loop, js, &bootstrap_req, key, "test/fixtures/bootstrap/no-platform-v1", on_bootstrap);
+  e = appling_bootstrap(loop, &bootstrap_req, key, "test/fixtures/bootstrap/no-platform-v1", NULL, on_bootstrap);
   assert(e == 0);
 }
 
@@ -47,9 +51,6 @@ main() {
 
   loop = uv_default_loop();
 
-  e = js_create_platform(loop, NULL, &js);
-  assert(e == 0);
-
   e = fs_unlink(loop, &unlink_req, "test/fixtures/bootstrap/no-platform-v1/current", on_unlink);
   assert(e == 0);
 
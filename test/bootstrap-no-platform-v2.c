@@ -1,6 +1,5 @@
 #include <assert.h>
 #include <fs.h>
-#include <js.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <uv.h>
@@ -13,8 +12,6 @@ fs_unlink_t unlink_req;
 
 appling_bootstrap_t bootstrap_req;
 
-js_platform_t *js;
-
 bool bootstrap_called = false;
 
 static void
@@ -25,8 +22,15 @@ on_bootstrap(appling_bootstrap_t *req, int status) {
 
   assert(status == 0);
 
-  e = js_destroy_platform(js);
+  printf("reused=%llu fetched=%llu\n", (unsigned long long) req->reused, (unsigned long long) req->fetched);
+
+  char timing[256];
+  size_t timing_len = sizeof(timing);
+
+  e = appling_bootstrap_format_timing(&req->timing, timing, &timing_len);
   assert(e == 0);
+
+  printf("%s\n", timing);
 }
 
 static void
@@ -37,7 +41,7 @@ on_unlink(fs_unlink_t *req, int status) {
 
   appling_key_t key = {0x6d, 0xd8, 0x97, 0x2d, 0xb0, 0x87, 0xad, 0x75, 0x41, 0x9a, 0x0b, 0x55, 0x4f, 0x6e, 0xa1, 0xfb, 0x22, 0x22, 0x3b, 0xa1, 0xf2, 0xc4, 0x84, 0x54, 0x41, 0xe0, 0x78, 0x8a, 0xf3, 0x0e, 0xf3, 0x7d};
 
-  e = appling_bootstrap(loop, js, &bootstrap_req, key, "test/fixtures/bootstrap/no-platform-v2", on_bootstrap);
+  e = appling_bootstrap(loop, &bootstrap_req, key, "test/fixtures/bootstrap/no-platform-v2", NULL, on_bootstrap);
   assert(e == 0);
 }
 
@@ -47,9 +51,6 @@ main() {
 
   loop = uv_default_loop();
 
-  e = js_create_platform(loop, NULL, &js);
-  assert(e == 0);
-
   e = fs_unlink(loop, &unlink_req, "test/fixtures/bootstrap/no-platform-v2/current", on_unlink);
   assert(e == 0);
 
@@ -0,0 +1,74 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#define KEY {0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa}
+
+#define DIR "test/fixtures/bootstrap/seed-archive"
+
+uv_loop_t *loop;
+
+appling_bootstrap_t bootstrap_req;
+
+appling_resolve_t resolve_req;
+
+appling_platform_t platform = {
+  .key = KEY,
+  .length = 123,
+};
+
+bool bootstrap_called = false;
+bool resolve_called = false;
+
+static void
+on_resolve(appling_resolve_t *req, int status) {
+  resolve_called = true;
+
+  assert(status == 0);
+
+  printf("path=%s\n", platform.path);
+  printf("length=%llu\n", (unsigned long long) platform.length);
+
+  assert(platform.length == 123);
+}
+
+static void
+on_bootstrap(appling_bootstrap_t *req, int status) {
+  int e;
+
+  bootstrap_called = true;
+
+  assert(status == 0);
+
+  e = appling_resolve(loop, &resolve_req, DIR, &platform, on_resolve);
+  assert(e == 0);
+}
+
+int
+main() {
+  int e;
+
+  loop = uv_default_loop();
+
+  appling_key_t key = KEY;
+
+  appling_bootstrap_options_t options = {
+    .version = 0,
+    .seed = "test/fixtures/platform-seed.tar",
+    .length = 123,
+  };
+
+  e = appling_bootstrap(loop, &bootstrap_req, key, DIR, &options, on_bootstrap);
+  assert(e == 0);
+
+  e = uv_run(loop, UV_RUN_DEFAULT);
+  assert(e == 0);
+
+  assert(bootstrap_called);
+  assert(resolve_called);
+
+  return 0;
+}
@@ -0,0 +1,135 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#define KEY {0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa}
+
+#define DIR  "test/fixtures/bootstrap/seed-dedupe"
+#define DKEY DIR "/by-dkey/23a6a52cfe22c9f30231e933716dee66641ded8db6dbb0e6395e34dea8bacd3a"
+
+#define SEED "test/fixtures/platform/by-dkey/aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa/0"
+
+uv_loop_t *loop;
+
+appling_bootstrap_t bootstrap_req;
+
+bool bootstrap_called = false;
+
+uint64_t entry_size;
+
+static void
+on_bootstrap(appling_bootstrap_t *req, int status) {
+  bootstrap_called = true;
+
+  assert(status == 0);
+
+  printf("deduped=%llu\n", (unsigned long long) req->deduped);
+
+  // Only the entry is shared between the versions, as the checkouts differ.
+  assert(req->deduped == entry_size);
+}
+
+static void
+mkdir_p(const char *path) {
+  char dir[512];
+  strcpy(dir, path);
+
+  for (char *c = dir + 1; *c; c++) {
+    if (*c != '/') continue;
+
+    *c = '\0';
+
+    uv_fs_t fs;
+    uv_fs_mkdir(loop, &fs, dir, 0777, NULL);
+    uv_fs_req_cleanup(&fs);
+
+    *c = '/';
+  }
+
+  uv_fs_t fs;
+  uv_fs_mkdir(loop, &fs, dir, 0777, NULL);
+  uv_fs_req_cleanup(&fs);
+}
+
+static void
+unlink_file(const char *path) {
+  uv_fs_t fs;
+  uv_fs_unlink(loop, &fs, path, NULL);
+  uv_fs_req_cleanup(&fs);
+}
+
+int
+main() {
+  int e;
+
+  loop = uv_default_loop();
+
+  // Install a previous version in the other slot with the same entry as the
+  // seed and a checkout of the same size but different contents.
+  char path[512], source[512];
+
+  snprintf(path, sizeof(path), "%s/1/by-arch/%s/lib", DKEY, appling_target);
+
+  mkdir_p(path);
+
+  snprintf(source, sizeof(source), "%s/by-arch/%s/lib/%s", SEED, appling_target, appling_platform_entry);
+  snprintf(path, sizeof(path), "%s/1/by-arch/%s/lib/%s", DKEY, appling_target, appling_platform_entry);
+
+  unlink_file(path);
+
+  uv_fs_t fs;
+  e = uv_fs_copyfile(loop, &fs, source, path, 0, NULL);
+  uv_fs_req_cleanup(&fs);
+  assert(e == 0);
+
+  e = uv_fs_stat(loop, &fs, source, NULL);
+  entry_size = fs.statbuf.st_size;
+  uv_fs_req_cleanup(&fs);
+  assert(e == 0);
+
+  snprintf(path, sizeof(path), "%s/1/checkout", DKEY);
+
+  unlink_file(path);
+
+  FILE *file = fopen(path, "wb");
+  assert(file);
+
+  size_t checkout_len = APPLING_KEY_LEN + 1 /* length */ + 1 /* fork */ + 1 + strlen(appling_os) + 1 + strlen(appling_arch);
+
+  for (size_t i = 0; i < checkout_len; i++) fputc(0xff, file);
+
+  fclose(file);
+
+  appling_key_t key = KEY;
+
+  appling_bootstrap_options_t options = {
+    .version = 0,
+    .seed = SEED,
+    .length = 123,
+    .dedupe = true,
+  };
+
+  e = appling_bootstrap(loop, &bootstrap_req, key, DIR, &options, on_bootstrap);
+  assert(e == 0);
+
+  e = uv_run(loop, UV_RUN_DEFAULT);
+  assert(e == 0);
+
+  assert(bootstrap_called);
+
+  // The installed checkout is left as it is.
+  snprintf(path, sizeof(path), "%s/0/checkout", DKEY);
+
+  file = fopen(path, "rb");
+  assert(file);
+
+  assert(fgetc(file) == 0xaa);
+
+  fclose(file);
+
+  return 0;
+}
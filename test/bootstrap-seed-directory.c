@@ -0,0 +1,111 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#define KEY {0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa}
+
+#define DIR  "test/fixtures/bootstrap/seed-directory"
+#define SLOT DIR "/by-dkey/23a6a52cfe22c9f30231e933716dee66641ded8db6dbb0e6395e34dea8bacd3a/0"
+
+uv_loop_t *loop;
+
+appling_bootstrap_t bootstrap_req;
+
+appling_resolve_t resolve_req;
+
+appling_platform_t platform = {
+  .key = KEY,
+  .length = 123,
+};
+
+bool bootstrap_called = false;
+bool resolve_called = false;
+
+static void
+on_resolve(appling_resolve_t *req, int status) {
+  resolve_called = true;
+
+  assert(status == 0);
+
+  printf("path=%s\n", platform.path);
+  printf("length=%llu\n", (unsigned long long) platform.length);
+
+  assert(platform.length == 123);
+}
+
+static void
+on_bootstrap(appling_bootstrap_t *req, int status) {
+  int e;
+
+  bootstrap_called = true;
+
+  assert(status == 0);
+
+  printf("peak_rss=%zu\n", req->peak_rss);
+
+  assert(req->peak_rss > 0);
+
+  // The older version that was installed in the slot has been replaced.
+  uv_fs_t fs;
+  e = uv_fs_stat(loop, &fs, SLOT "/stale", NULL);
+  uv_fs_req_cleanup(&fs);
+  assert(e == UV_ENOENT);
+
+  e = appling_resolve(loop, &resolve_req, DIR, &platform, on_resolve);
+  assert(e == 0);
+}
+
+int
+main() {
+  int e;
+
+  loop = uv_default_loop();
+
+  // Leave an older version in the slot that the seed installs to, with a
+  // checkout of a length below that of the seed.
+  uv_fs_t fs;
+
+  const char *dirs[] = {DIR "/by-dkey", DIR "/by-dkey/23a6a52cfe22c9f30231e933716dee66641ded8db6dbb0e6395e34dea8bacd3a", SLOT, SLOT "/by-arch", SLOT "/by-arch/" APPLING_TARGET};
+
+  for (size_t i = 0; i < sizeof(dirs) / sizeof(dirs[0]); i++) {
+    uv_fs_mkdir(loop, &fs, dirs[i], 0777, NULL);
+    uv_fs_req_cleanup(&fs);
+  }
+
+  appling_key_t key = KEY;
+
+  FILE *file = fopen(SLOT "/checkout", "wb");
+  assert(file);
+
+  fwrite(key, 1, APPLING_KEY_LEN, file);
+  fputc(1, file); // Length
+  fputc(0, file); // Fork
+
+  fclose(file);
+
+  file = fopen(SLOT "/stale", "wb");
+  assert(file);
+
+  fclose(file);
+
+  appling_bootstrap_options_t options = {
+    .version = 0,
+    .seed = "test/fixtures/platform/by-dkey/aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa/0",
+    .length = 123,
+  };
+
+  e = appling_bootstrap(loop, &bootstrap_req, key, DIR, &options, on_bootstrap);
+  assert(e == 0);
+
+  e = uv_run(loop, UV_RUN_DEFAULT);
+  assert(e == 0);
+
+  assert(bootstrap_called);
+  assert(resolve_called);
+
+  return 0;
+}
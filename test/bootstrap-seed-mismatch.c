@@ -0,0 +1,98 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#define KEY {0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa}
+
+#define OTHER_KEY {0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb, 0xbb}
+
+#define DIR "test/fixtures/bootstrap/seed-mismatch"
+
+uv_loop_t *loop;
+
+appling_bootstrap_t bootstrap_reqs[3];
+
+int bootstrap_called = 0;
+
+static void
+bootstrap(void);
+
+static void
+on_bootstrap(appling_bootstrap_t *req, int status) {
+  bootstrap_called++;
+
+  assert(status != 0);
+
+  printf("bootstrap %d failed as expected\n", bootstrap_called);
+
+  if (bootstrap_called < 3) bootstrap();
+}
+
+static void
+bootstrap(void) {
+  int e;
+
+  appling_key_t key = KEY;
+  appling_key_t other_key = OTHER_KEY;
+
+  appling_bootstrap_options_t options = {
+    .version = 0,
+    .seed = "test/fixtures/platform/by-dkey/aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa/0",
+    .length = 123,
+  };
+
+  switch (bootstrap_called) {
+  case 0: // The seed is of another key
+    e = appling_bootstrap(loop, &bootstrap_reqs[bootstrap_called], other_key, DIR, &options, on_bootstrap);
+    break;
+
+  case 1: // The seed is older than required
+    options.length = 124;
+
+    e = appling_bootstrap(loop, &bootstrap_reqs[bootstrap_called], key, DIR, &options, on_bootstrap);
+    break;
+
+  default: // The seed keeps the platform under a discovery key not of the key
+    options.seed = "test/fixtures/platform";
+
+    e = appling_bootstrap(loop, &bootstrap_reqs[bootstrap_called], key, DIR, &options, on_bootstrap);
+    break;
+  }
+
+  assert(e == 0);
+}
+
+static bool
+exists(const char *name) {
+  char path[256];
+  snprintf(path, sizeof(path), "%s/%s", DIR, name);
+
+  uv_fs_t req;
+  int e = uv_fs_lstat(loop, &req, path, NULL);
+  uv_fs_req_cleanup(&req);
+
+  return e == 0;
+}
+
+int
+main() {
+  int e;
+
+  loop = uv_default_loop();
+
+  bootstrap();
+
+  e = uv_run(loop, UV_RUN_DEFAULT);
+  assert(e == 0);
+
+  assert(bootstrap_called == 3);
+
+  assert(!exists("current"));
+  assert(!exists("by-dkey"));
+  assert(!exists("seed"));
+
+  return 0;
+}
@@ -0,0 +1,123 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#define KEY {0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa}
+
+#define DIR "test/fixtures/bootstrap/seed-process"
+
+uv_loop_t *loop;
+
+appling_bootstrap_t bootstrap_req;
+appling_bootstrap_t unreported_req;
+
+appling_resolve_t resolve_req;
+
+appling_platform_t platform = {
+  .key = KEY,
+  .length = 123,
+};
+
+bool bootstrap_called = false;
+bool resolve_called = false;
+bool unreported_called = false;
+
+static void
+on_unreported(appling_bootstrap_t *req, int status) {
+  unreported_called = true;
+
+  printf("status=%d error=%s\n", status, req->error);
+
+  // A child that exits cleanly without reporting a result installed nothing.
+  assert(status != 0);
+  assert(req->error);
+}
+
+static void
+on_resolve(appling_resolve_t *req, int status) {
+  resolve_called = true;
+
+  assert(status == 0);
+
+  printf("path=%s\n", platform.path);
+  printf("length=%llu\n", (unsigned long long) platform.length);
+
+  assert(platform.length == 123);
+
+  // Spawn an executable that ignores the bootstrap flag and exits cleanly.
+  appling_path_t executable;
+  size_t executable_len = sizeof(appling_path_t);
+
+  int e = uv_exepath(executable, &executable_len);
+  assert(e == 0);
+
+  char *end = executable + strlen(executable);
+
+  while (end > executable && end[-1] != '/' && end[-1] != '\\') end--;
+
+  strcpy(end, "fixtures/runtime");
+
+  appling_key_t key = KEY;
+
+  appling_bootstrap_options_t options = {
+    .version = 0,
+    .seed = "test/fixtures/platform/by-dkey/aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa/0",
+    .length = 123,
+    .spawn = true,
+    .executable = executable,
+  };
+
+  e = appling_bootstrap(loop, &unreported_req, key, DIR, &options, on_unreported);
+  assert(e == 0);
+}
+
+static void
+on_bootstrap(appling_bootstrap_t *req, int status) {
+  int e;
+
+  bootstrap_called = true;
+
+  assert(status == 0);
+
+  printf("peak_rss=%zu\n", req->peak_rss);
+
+  assert(req->peak_rss > 0);
+
+  e = appling_resolve(loop, &resolve_req, DIR, &platform, on_resolve);
+  assert(e == 0);
+}
+
+int
+main(int argc, char **argv) {
+  int e;
+
+  e = appling_bootstrap_main(argc, argv);
+  if (e >= 0) return e;
+
+  loop = uv_default_loop();
+
+  appling_key_t key = KEY;
+
+  appling_bootstrap_options_t options = {
+    .version = 0,
+    .seed = "test/fixtures/platform/by-dkey/aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa/0",
+    .length = 123,
+    .spawn = true,
+  };
+
+  e = appling_bootstrap(loop, &bootstrap_req, key, DIR, &options, on_bootstrap);
+  assert(e == 0);
+
+  e = uv_run(loop, UV_RUN_DEFAULT);
+  assert(e == 0);
+
+  assert(bootstrap_called);
+  assert(resolve_called);
+  assert(unreported_called);
+
+  return 0;
+}
@@ -0,0 +1,70 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+#include "fixtures/testnet.h"
+
+uv_loop_t *loop;
+
+appling_test_testnet_t testnet;
+
+appling_bootstrap_t bootstrap_reqs[2];
+
+int bootstrap_called = 0;
+
+static void
+on_bootstrap(appling_bootstrap_t *req, int status) {
+  assert(status == 0);
+
+  printf("reused=%llu fetched=%llu\n", (unsigned long long) req->reused, (unsigned long long) req->fetched);
+
+  if (++bootstrap_called == 2) appling_test_testnet_stop(&testnet);
+}
+
+static void
+on_testnet(appling_test_testnet_t *testnet) {
+  int e;
+
+  appling_bootstrap_options_t options = {
+    .version = 0,
+    .shared = true,
+    .nodes = testnet->nodes,
+  };
+
+  const char *dirs[] = {
+    "test/fixtures/bootstrap/shared-a",
+    "test/fixtures/bootstrap/shared-b",
+  };
+
+  for (int i = 0; i < 2; i++) {
+    e = appling_bootstrap(loop, &bootstrap_reqs[i], testnet->keys[i], dirs[i], &options, on_bootstrap);
+    assert(e == 0);
+  }
+}
+
+int
+main() {
+  int e;
+
+  loop = uv_default_loop();
+
+  appling_test_testnet_start(loop, &testnet, 2, on_testnet);
+
+  e = uv_run(loop, UV_RUN_DEFAULT);
+  assert(e == 0);
+
+  assert(bootstrap_called == 2);
+
+  for (int i = 0; i < 2; i++) assert(bootstrap_reqs[i].fetched > 0);
+
+  printf("connections=%llu uploaded=%llu\n", (unsigned long long) testnet.connections, (unsigned long long) testnet.uploaded);
+
+  // Both platforms were fetched over the one connection of the shared swarm.
+  assert(testnet.stopped);
+  assert(testnet.connections == 1);
+  assert(testnet.uploaded >= 2 * APPLING_TEST_TESTNET_SIZE);
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+#include <assert.h>
+#include <fs.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+#include "fixtures/testnet.h"
+
+uv_loop_t *loop;
+
+fs_unlink_t unlink_req;
+
+appling_test_testnet_t testnet;
+
+appling_bootstrap_t bootstrap_reqs[2];
+
+int bootstrap_called = 0;
+
+static void
+on_progress(uint64_t downloaded, uint64_t total) {
+  printf("downloaded=%llu total=%llu\n", (unsigned long long) downloaded, (unsigned long long) total);
+}
+
+static void
+on_bootstrap(appling_bootstrap_t *req, int status) {
+  assert(status == 0);
+
+  printf("reused=%llu fetched=%llu\n", (unsigned long long) req->reused, (unsigned long long) req->fetched);
+
+  if (++bootstrap_called == 2) appling_test_testnet_stop(&testnet);
+}
+
+static void
+on_testnet(appling_test_testnet_t *testnet) {
+  int e;
+
+  appling_bootstrap_options_t options = {
+    .version = 0,
+    .progress = on_progress,
+    .nodes = testnet->nodes,
+  };
+
+  for (int i = 0; i < 2; i++) {
+    e = appling_bootstrap(loop, &bootstrap_reqs[i], testnet->keys[0], "test/fixtures/bootstrap/single-flight", &options, on_bootstrap);
+    assert(e == 0);
+  }
+}
+
+static void
+on_unlink(fs_unlink_t *req, int status) {
+  (void) status;
+
+  appling_test_testnet_start(loop, &testnet, 1, on_testnet);
+}
+
+int
+main() {
+  int e;
+
+  loop = uv_default_loop();
+
+  e = fs_unlink(loop, &unlink_req, "test/fixtures/bootstrap/single-flight/current", on_unlink);
+  assert(e == 0);
+
+  e = uv_run(loop, UV_RUN_DEFAULT);
+  assert(e == 0);
+
+  assert(bootstrap_called == 2);
+
+  // Only the first bootstrap downloaded the platform, the second waited for it
+  // and adopted its result.
+  assert((bootstrap_reqs[0].fetched > 0) != (bootstrap_reqs[1].fetched > 0));
+
+  printf("connections=%llu uploaded=%llu\n", (unsigned long long) testnet.connections, (unsigned long long) testnet.uploaded);
+
+  assert(testnet.stopped);
+  assert(testnet.connections == 1);
+  assert(testnet.uploaded >= APPLING_TEST_TESTNET_SIZE);
+  assert(testnet.uploaded < 2 * APPLING_TEST_TESTNET_SIZE);
+
+  return 0;
+}
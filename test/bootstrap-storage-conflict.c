@@ -0,0 +1,85 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#define KEY {0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa}
+
+#define DIR     "test/fixtures/bootstrap/storage-conflict"
+#define STORAGE DIR "/storage"
+
+uv_loop_t *loop;
+
+appling_bootstrap_t req;
+
+bool bootstrap_called = false;
+
+static void
+on_bootstrap(appling_bootstrap_t *req, int status) {
+  int e;
+
+  bootstrap_called = true;
+
+  printf("status=%d error=%s\n", status, req->error ? req->error : "");
+
+  assert(status != 0);
+  assert(req->error);
+
+  // Neither of the stores has been discarded.
+  uv_fs_t fs;
+  e = uv_fs_stat(loop, &fs, DIR "/corestores/platform/blocks", NULL);
+  uv_fs_req_cleanup(&fs);
+  assert(e == 0);
+
+  e = uv_fs_stat(loop, &fs, STORAGE "/blocks", NULL);
+  uv_fs_req_cleanup(&fs);
+  assert(e == 0);
+}
+
+static void
+touch(const char *path) {
+  FILE *file = fopen(path, "wb");
+  assert(file);
+
+  fclose(file);
+}
+
+int
+main() {
+  int e;
+
+  loop = uv_default_loop();
+
+  // Leave storage both in the platform directory and at the requested
+  // location.
+  uv_fs_t fs;
+
+  const char *dirs[] = {DIR "/corestores", DIR "/corestores/platform", STORAGE};
+
+  for (size_t i = 0; i < sizeof(dirs) / sizeof(dirs[0]); i++) {
+    uv_fs_mkdir(loop, &fs, dirs[i], 0777, NULL);
+    uv_fs_req_cleanup(&fs);
+  }
+
+  touch(DIR "/corestores/platform/blocks");
+  touch(STORAGE "/blocks");
+
+  appling_key_t key = KEY;
+
+  appling_bootstrap_options_t options = {
+    .version = 0,
+    .storage = STORAGE,
+  };
+
+  e = appling_bootstrap(loop, &req, key, DIR, &options, on_bootstrap);
+  assert(e == 0);
+
+  e = uv_run(loop, UV_RUN_DEFAULT);
+  assert(e == 0);
+
+  assert(bootstrap_called);
+
+  return 0;
+}
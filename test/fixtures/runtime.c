@@ -1,7 +1,257 @@
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Stands in for the platform runtime, printing its arguments. The behaviour
+// can be changed through the `APPLING_TEST_RUNTIME` environment variable, which
+// is inherited from the test spawning it:
+//
+//   hang      Never exit, as a runtime that misses its deadline.
+//   progress  Report the progress of a preflight before exiting, see below.
+//   count     Log its start and exit to the file named by the environment, see
+//             below.
+
+#define PROGRESS_TOTAL 1000
+#define PROGRESS_BURST 100
+
+static void
+hang(void) {
+  for (;;) {
+#ifdef _WIN32
+    Sleep(INFINITE);
+#else
+    pause();
+#endif
+  }
+}
+
+#ifndef _WIN32
+static size_t
+encode_uint(uint8_t *buf, uint64_t n) {
+  if (n < 0xfd) {
+    buf[0] = (uint8_t) n;
+    return 1;
+  }
+
+  size_t len = n <= 0xffff ? 2 : n <= 0xffffffff ? 4 : 8;
+
+  buf[0] = len == 2 ? 0xfd : len == 4 ? 0xfe : 0xff;
+
+  for (size_t i = 0; i < len; i++) buf[1 + i] = (uint8_t) (n >> (8 * i));
+
+  return 1 + len;
+}
+
+static size_t
+encode_progress(uint8_t *buf, uint64_t downloaded, uint64_t total) {
+  uint8_t record[32];
+  size_t len = 0;
+
+  len += encode_uint(record + len, 1 /* Progress */);
+  len += encode_uint(record + len, downloaded);
+  len += encode_uint(record + len, total);
+
+  size_t n = encode_uint(buf, len);
+
+  memcpy(buf + n, record, len);
+
+  return n + len;
+}
+
+// Report the progress of a preflight over the pipe named by the environment,
+// starting with a record split across two writes, followed by a burst of
+// records written at once, and ending with the final record.
+static void
+progress(void) {
+  const char *env = getenv("PEAR_PREFLIGHT_PROGRESS_FD");
+  if (env == NULL) return;
+
+  int fd = atoi(env);
+
+  uint8_t buf[PROGRESS_BURST * 16];
+  size_t len;
+
+  len = encode_progress(buf, 0, PROGRESS_TOTAL);
+
+  if (write(fd, buf, 2) != 2) return;
+
+  usleep(50000);
+
+  if (write(fd, buf + 2, len - 2) != (ssize_t) (len - 2)) return;
+
+  len = 0;
+
+  for (uint64_t i = 1; i < PROGRESS_BURST; i++) {
+    len += encode_progress(buf + len, i * PROGRESS_TOTAL / PROGRESS_BURST, PROGRESS_TOTAL);
+  }
+
+  if (write(fd, buf, len) != (ssize_t) len) return;
+
+  len = encode_progress(buf, PROGRESS_TOTAL, PROGRESS_TOTAL);
+
+  if (write(fd, buf, len) != (ssize_t) len) return;
+
+  close(fd);
+}
+#endif
+
+#ifndef _WIN32
+// Append `+` to the file named by `APPLING_TEST_RUNTIME_LOG` on starting and
+// `-` on exiting, running for long enough in between that runtimes started
+// together overlap. The most `+` without a matching `-` at any point of the
+// log is the most runtimes that ran at once.
+static void
+count(void) {
+  const char *path = getenv("APPLING_TEST_RUNTIME_LOG");
+  if (path == NULL) return;
+
+  int fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0666);
+  if (fd < 0) return;
+
+  if (write(fd, "+", 1) != 1) return;
+
+  usleep(50000);
+
+  if (write(fd, "-", 1) != 1) return;
+
+  close(fd);
+}
+#endif
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Stands in for a launcher service when run as `runtime launcher <socket>`,
+// taking a single launch and printing it.
+
+static int
+read_all(int fd, uint8_t *buf, size_t len) {
+  while (len > 0) {
+    ssize_t n = read(fd, buf, len);
+    if (n <= 0) return -1;
+
+    buf += n;
+    len -= n;
+  }
+
+  return 0;
+}
+
+static int
+decode_uint(const uint8_t **buf, const uint8_t *end, uint64_t *result) {
+  if (*buf >= end) return -1;
+
+  uint8_t b = *(*buf)++;
+
+  size_t len = b == 0xfd ? 2 : b == 0xfe ? 4 : b == 0xff ? 8 : 0;
+
+  if (len == 0) {
+    *result = b;
+    return 0;
+  }
+
+  if ((size_t) (end - *buf) < len) return -1;
+
+  *result = 0;
+
+  for (size_t i = 0; i < len; i++) *result |= (uint64_t) (*buf)[i] << (8 * i);
+
+  *buf += len;
+
+  return 0;
+}
+
+static int
+launcher(const char *path) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return 1;
+
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+  unlink(path);
+
+  if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) return 1;
+  if (listen(fd, 1) < 0) return 1;
+
+  int conn = accept(fd, NULL, NULL);
+  if (conn < 0) return 1;
+
+  uint8_t header[9];
+  if (read_all(conn, header, 1) < 0) return 1;
+
+  size_t header_len = header[0] == 0xfd ? 3 : header[0] == 0xfe ? 5 : header[0] == 0xff ? 9 : 1;
+  if (read_all(conn, header + 1, header_len - 1) < 0) return 1;
+
+  const uint8_t *p = header;
+
+  uint64_t len;
+  if (decode_uint(&p, header + header_len, &len) < 0 || len > 65536) return 1;
+
+  uint8_t message[65536];
+  if (read_all(conn, message, len) < 0) return 1;
+
+  p = message;
+
+  const uint8_t *end = message + len;
+
+  const char *fields[] = {"link", "appling", "name"};
+
+  for (int i = 0; i < 3; i++) {
+    uint64_t field_len;
+    if (decode_uint(&p, end, &field_len) < 0 || (uint64_t) (end - p) < field_len) return 1;
+
+    printf("%s=%.*s\n", fields[i], (int) field_len, (const char *) p);
+
+    p += field_len;
+  }
+
+  if (end - p < 32) return 1;
+
+  p += 32; // Platform key
+
+  uint64_t length, fork;
+  if (decode_uint(&p, end, &length) < 0 || decode_uint(&p, end, &fork) < 0) return 1;
+
+  printf("length=%llu fork=%llu\n", (unsigned long long) length, (unsigned long long) fork);
+
+  uint8_t reply = 0;
+  if (write(conn, &reply, 1) != 1) return 1;
+
+  close(conn);
+  close(fd);
+
+  unlink(path);
+
+  return 0;
+}
+#endif
 
 int
 main(int argc, char *argv[]) {
+#ifndef _WIN32
+  if (argc == 3 && strcmp(argv[1], "launcher") == 0) return launcher(argv[2]);
+#endif
+
+  const char *mode = getenv("APPLING_TEST_RUNTIME");
+
+  if (mode && strcmp(mode, "hang") == 0) hang();
+
+#ifndef _WIN32
+  if (mode && strcmp(mode, "progress") == 0) progress();
+
+  if (mode && strcmp(mode, "count") == 0) count();
+#endif
+
   for (int i = 0; i < argc; i++) {
     printf("%d=%s\n", i, argv[i]);
   }
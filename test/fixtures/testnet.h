@@ -0,0 +1,186 @@
+#ifndef APPLING_TEST_FIXTURES_TESTNET_H
+#define APPLING_TEST_FIXTURES_TESTNET_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../../include/appling.h"
+
+// Runs `node bench/testnet.js` so that bootstraps can be tested against a
+// local DHT testnet and a peer seeding synthetic platforms rather than the
+// public network. Once stopped, the number of connections made to the peer and
+// the number of bytes it uploaded are available.
+
+#define APPLING_TEST_TESTNET_SIZE (1024 * 1024)
+#define APPLING_TEST_TESTNET_MAX  4
+
+typedef struct appling_test_testnet_s appling_test_testnet_t;
+
+typedef void (*appling_test_testnet_cb)(appling_test_testnet_t *testnet);
+
+struct appling_test_testnet_s {
+  uv_process_t process;
+  uv_pipe_t input;
+  uv_pipe_t output;
+
+  char buffer[4096];
+  size_t buffer_len;
+
+  appling_test_testnet_cb cb;
+
+  appling_key_t keys[APPLING_TEST_TESTNET_MAX];
+  size_t count;
+
+  char nodes[APPLING_NODES_MAX + 1 /* NULL */];
+
+  bool started;
+  bool stopped;
+
+  uint64_t connections;
+  uint64_t uploaded;
+};
+
+static inline int
+appling_test_testnet__hex(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+static inline void
+appling_test_testnet__on_started(appling_test_testnet_t *testnet, char *line) {
+  char *nodes = strrchr(line, ' ');
+  assert(nodes);
+
+  *nodes++ = '\0';
+
+  assert(strlen(nodes) <= APPLING_NODES_MAX);
+
+  strcpy(testnet->nodes, nodes);
+
+  for (char *key = strtok(line, " "); key; key = strtok(NULL, " ")) {
+    assert(strlen(key) == APPLING_KEY_LEN * 2);
+    assert(testnet->count < APPLING_TEST_TESTNET_MAX);
+
+    for (size_t i = 0; i < APPLING_KEY_LEN; i++) {
+      testnet->keys[testnet->count][i] = (uint8_t) (appling_test_testnet__hex(key[i * 2]) << 4 | appling_test_testnet__hex(key[i * 2 + 1]));
+    }
+
+    testnet->count++;
+  }
+
+  testnet->started = true;
+
+  testnet->cb(testnet);
+}
+
+static inline void
+appling_test_testnet__on_stopped(appling_test_testnet_t *testnet, char *line) {
+  unsigned long long connections, uploaded;
+
+  int n = sscanf(line, "connections=%llu uploaded=%llu", &connections, &uploaded);
+  assert(n == 2);
+
+  testnet->connections = connections;
+  testnet->uploaded = uploaded;
+
+  testnet->stopped = true;
+}
+
+static inline void
+appling_test_testnet__on_alloc(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
+  appling_test_testnet_t *testnet = (appling_test_testnet_t *) handle->data;
+
+  *buf = uv_buf_init(testnet->buffer + testnet->buffer_len, sizeof(testnet->buffer) - testnet->buffer_len - 1);
+}
+
+static inline void
+appling_test_testnet__on_read(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf) {
+  appling_test_testnet_t *testnet = (appling_test_testnet_t *) stream->data;
+
+  if (nread < 0) {
+    uv_close((uv_handle_t *) stream, NULL);
+    return;
+  }
+
+  testnet->buffer_len += nread;
+  testnet->buffer[testnet->buffer_len] = '\0';
+
+  char *end;
+
+  while ((end = strchr(testnet->buffer, '\n'))) {
+    *end = '\0';
+
+    if (testnet->started) appling_test_testnet__on_stopped(testnet, testnet->buffer);
+    else appling_test_testnet__on_started(testnet, testnet->buffer);
+
+    testnet->buffer_len -= end + 1 - testnet->buffer;
+
+    memmove(testnet->buffer, end + 1, testnet->buffer_len + 1 /* NULL */);
+  }
+}
+
+static inline void
+appling_test_testnet__on_exit(uv_process_t *handle, int64_t exit_status, int term_signal) {
+  assert(exit_status == 0);
+
+  uv_close((uv_handle_t *) handle, NULL);
+}
+
+static inline void
+appling_test_testnet_start(uv_loop_t *loop, appling_test_testnet_t *testnet, size_t count, appling_test_testnet_cb cb) {
+  int err;
+
+  memset(testnet, 0, sizeof(*testnet));
+
+  testnet->cb = cb;
+
+  testnet->input.data = testnet;
+  testnet->output.data = testnet;
+
+  char size[32];
+  snprintf(size, sizeof(size), "%d", APPLING_TEST_TESTNET_SIZE);
+
+  char n[32];
+  snprintf(n, sizeof(n), "%zu", count);
+
+  char *args[] = {"node", "bench/testnet.js", size, n, NULL};
+
+  err = uv_pipe_init(loop, &testnet->input, 0);
+  assert(err == 0);
+
+  err = uv_pipe_init(loop, &testnet->output, 0);
+  assert(err == 0);
+
+  uv_stdio_container_t stdio[] = {
+    {.flags = UV_CREATE_PIPE | UV_READABLE_PIPE, .data.stream = (uv_stream_t *) &testnet->input},
+    {.flags = UV_CREATE_PIPE | UV_WRITABLE_PIPE, .data.stream = (uv_stream_t *) &testnet->output},
+    {.flags = UV_INHERIT_FD, .data.fd = 2},
+  };
+
+  uv_process_options_t options = {
+    .exit_cb = appling_test_testnet__on_exit,
+    .file = "node",
+    .args = args,
+    .stdio_count = 3,
+    .stdio = stdio,
+  };
+
+  err = uv_spawn(loop, &testnet->process, &options);
+  assert(err == 0);
+
+  err = uv_read_start((uv_stream_t *) &testnet->output, appling_test_testnet__on_alloc, appling_test_testnet__on_read);
+  assert(err == 0);
+}
+
+static inline void
+appling_test_testnet_stop(appling_test_testnet_t *testnet) {
+  uv_close((uv_handle_t *) &testnet->input, NULL);
+}
+
+#endif // APPLING_TEST_FIXTURES_TESTNET_H
@@ -0,0 +1,164 @@
+#include <assert.h>
+#include <path.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#define DIR    "test/fixtures/gc"
+#define DKEY_A DIR "/by-dkey/aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+#define DKEY_B DIR "/by-dkey/bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb"
+
+#define CHECKOUT_LEN (APPLING_KEY_LEN + 1 /* length */ + 1 /* fork */)
+
+uv_loop_t *loop;
+
+appling_gc_t req;
+
+bool gc_called = false;
+
+static void
+on_gc(appling_gc_t *req, int status) {
+  gc_called = true;
+
+  assert(status == 0);
+
+  printf("removed=%zu reclaimed=%llu\n", req->removed, (unsigned long long) req->reclaimed);
+
+  assert(req->removed == 1);
+  assert(req->reclaimed == 1000 + CHECKOUT_LEN);
+}
+
+// Make a version in the given slot, with a checkout of the given length
+// unless it is 0 in which case the version is still being installed.
+static void
+make_version(const char *dkey, const char *slot, size_t size, uint8_t length) {
+  uv_fs_t fs;
+
+  char path[256];
+  snprintf(path, sizeof(path), "%s/%s", dkey, slot);
+
+  uv_fs_mkdir(loop, &fs, path, 0777, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  snprintf(path, sizeof(path), "%s/%s/lib", dkey, slot);
+
+  uv_fs_mkdir(loop, &fs, path, 0777, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  snprintf(path, sizeof(path), "%s/%s/lib/launch", dkey, slot);
+
+  FILE *file = fopen(path, "wb");
+  assert(file);
+
+  for (size_t i = 0; i < size; i++) fputc('a', file);
+
+  fclose(file);
+
+  snprintf(path, sizeof(path), "%s/%s/checkout", dkey, slot);
+
+  uv_fs_unlink(loop, &fs, path, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  if (length == 0) return;
+
+  file = fopen(path, "wb");
+  assert(file);
+
+  for (size_t i = 0; i < APPLING_KEY_LEN; i++) fputc(0xaa, file);
+
+  fputc(length, file);
+  fputc(0, file); // Fork
+
+  fclose(file);
+}
+
+static bool
+exists(const char *dkey, const char *slot) {
+  char path[256];
+  snprintf(path, sizeof(path), "%s/%s", dkey, slot);
+
+  uv_fs_t fs;
+  int err = uv_fs_stat(loop, &fs, path, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  return err == 0;
+}
+
+static void
+link_version(const char *name, const char *dkey, const char *slot) {
+  int err;
+
+  appling_path_t cwd;
+  size_t cwd_len = sizeof(appling_path_t);
+
+  err = uv_cwd(cwd, &cwd_len);
+  assert(err == 0);
+
+  appling_path_t target;
+  size_t target_len = sizeof(appling_path_t);
+
+  path_join(
+    (const char *[]) {cwd, dkey, slot, NULL},
+    target,
+    &target_len,
+    path_behavior_system
+  );
+
+  char path[256];
+  snprintf(path, sizeof(path), "%s/%s", DIR, name);
+
+  uv_fs_t fs;
+  uv_fs_unlink(loop, &fs, path, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  err = uv_fs_symlink(loop, &fs, target, path, UV_FS_SYMLINK_JUNCTION, NULL);
+  uv_fs_req_cleanup(&fs);
+  assert(err == 0);
+}
+
+int
+main() {
+  int err;
+
+  loop = uv_default_loop();
+
+  uv_fs_t fs;
+
+  uv_fs_mkdir(loop, &fs, DIR "/by-dkey", 0777, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  uv_fs_mkdir(loop, &fs, DKEY_A, 0777, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  uv_fs_mkdir(loop, &fs, DKEY_B, 0777, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  // The version in the later slot is the older one.
+  make_version(DKEY_A, "0", 4000, 124);
+  make_version(DKEY_A, "1", 1000, 123);
+
+  make_version(DKEY_B, "0", 2000, 0);
+  make_version(DKEY_B, "1", 3000, 10);
+
+  link_version("current", DKEY_A, "0");
+  link_version("next", DKEY_B, "1");
+
+  err = appling_gc(loop, &req, DIR, NULL, on_gc);
+  assert(err == 0);
+
+  uv_run(loop, UV_RUN_DEFAULT);
+
+  assert(gc_called);
+
+  // The older version of the current platform is removed, but the version of
+  // the next platform that has yet to be installed is kept.
+  assert(exists(DKEY_A, "0"));
+  assert(!exists(DKEY_A, "1"));
+  assert(exists(DKEY_B, "0"));
+  assert(exists(DKEY_B, "1"));
+
+  return 0;
+}
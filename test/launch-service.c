@@ -0,0 +1,120 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+#include "fixtures/app.h"
+
+#define EXE    "test/fixtures/app/" APPLING_TARGET "/" APPLING_TEST_EXE
+#define DIR    "test/fixtures/launcher"
+#define SOCKET DIR "/pear-launcher.sock"
+
+uv_loop_t *loop;
+
+appling_platform_t platform;
+
+appling_resolve_t req;
+
+uv_process_t service;
+
+bool service_exited = false;
+
+static void
+on_service_exit(uv_process_t *process, int64_t exit_status, int term_signal) {
+  service_exited = true;
+
+  assert(exit_status == 0);
+  assert(term_signal == 0);
+
+  uv_close((uv_handle_t *) process, NULL);
+}
+
+static void
+on_resolve(appling_resolve_t *req, int status) {
+  int err;
+
+  assert(status == 0);
+
+  appling_app_t app = {
+    .path = EXE,
+  };
+
+  appling_link_t link = {
+    .id = "bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb",
+  };
+
+  // Leave no runtime to fall back to so that only the service can launch.
+  strcpy(platform.path, DIR "/missing");
+
+  err = appling_launch_service(&platform, &app, &link, "Example");
+  assert(err == 0);
+}
+
+int
+main() {
+  int err;
+
+  loop = uv_default_loop();
+
+  char runtime[4096];
+  size_t runtime_len = sizeof(runtime);
+
+  err = uv_exepath(runtime, &runtime_len);
+  assert(err == 0);
+
+  *strrchr(runtime, '/') = '\0';
+
+  strcat(runtime, "/fixtures/runtime");
+
+  // Have the service listen in the runtime directory of the user, where the
+  // launch looks for it by default.
+  unsetenv("PEAR_LAUNCHER_SOCKET");
+  setenv("XDG_RUNTIME_DIR", DIR, 1);
+
+  uv_fs_t fs;
+  uv_fs_unlink(loop, &fs, SOCKET, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  char *args[] = {runtime, "launcher", SOCKET, NULL};
+
+  uv_stdio_container_t stdio[3] = {
+    {.flags = UV_IGNORE},
+    {.flags = UV_INHERIT_FD, .data.fd = 1},
+    {.flags = UV_INHERIT_FD, .data.fd = 2},
+  };
+
+  uv_process_options_t options = {
+    .exit_cb = on_service_exit,
+    .file = runtime,
+    .args = args,
+    .stdio_count = 3,
+    .stdio = stdio,
+  };
+
+  err = uv_spawn(loop, &service, &options);
+  assert(err == 0);
+
+  // Wait for the service to listen.
+  for (int i = 0; i < 500; i++) {
+    err = uv_fs_stat(loop, &fs, SOCKET, NULL);
+    uv_fs_req_cleanup(&fs);
+
+    if (err == 0) break;
+
+    uv_sleep(10);
+  }
+
+  assert(err == 0);
+
+  err = appling_resolve(loop, &req, "test/fixtures/platform", &platform, on_resolve);
+  assert(err == 0);
+
+  uv_run(loop, UV_RUN_DEFAULT);
+
+  assert(service_exited);
+
+  return 0;
+}
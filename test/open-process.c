@@ -0,0 +1,61 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+uv_loop_t *loop;
+
+appling_process_t process;
+
+bool process_called = false;
+
+static void
+on_process(appling_process_t *process, int status, int64_t exit_status, int term_signal) {
+  process_called = true;
+
+  printf("status=%d exit_status=%lld term_signal=%d\n", status, (long long) exit_status, term_signal);
+
+  assert(status == 0);
+  assert(exit_status == 3);
+  assert(term_signal == 0);
+}
+
+int
+main(int argc, char *argv[]) {
+  int err;
+
+  // Opened by ourselves, with the argument passed as the first argument.
+  if (argc == 2 && strcmp(argv[1], "exit") == 0) return 3;
+
+  loop = uv_default_loop();
+
+  appling_app_t app;
+  size_t path_len = sizeof(app.path);
+
+  err = uv_exepath(app.path, &path_len);
+  assert(err == 0);
+
+  err = appling_open_process(loop, &process, &app, "exit", on_process);
+  assert(err == 0);
+
+  assert(process.pid > 0);
+
+  uv_run(loop, UV_RUN_DEFAULT);
+
+  assert(process_called);
+
+  // Opened without a loop to reap it on, which only fails if there is no such
+  // application.
+  err = appling_open(&app, "exit");
+  assert(err == 0);
+
+  appling_app_t missing = {.path = "test/fixtures/missing"};
+
+  err = appling_open(&missing, NULL);
+  assert(err == -1);
+
+  return 0;
+}
@@ -0,0 +1,169 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#define KEY {0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa}
+
+#define ID       "cccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccc"
+#define OTHER_ID "dddddddddddddddddddddddddddddddddddddddddddddddddddddddddddddddd"
+
+#define FIXTURE "test/fixtures/platform/by-dkey/aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa/0/by-arch/" APPLING_TARGET
+
+// A copy of the fixture platform, so that the cache written next to it and the
+// removal of its runtime don't affect other tests.
+#define DIR      "test/fixtures/ready-cache"
+#define PLATFORM DIR "/by-dkey/aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa/0/by-arch/" APPLING_TARGET
+
+#if defined(APPLING_OS_WIN32)
+#define RUNTIME "/bin/pear-runtime.exe"
+#else
+#define RUNTIME "/bin/pear-runtime"
+#endif
+
+uv_loop_t *loop;
+
+appling_platform_t platform = {
+  .path = PLATFORM,
+  .key = KEY,
+  .length = 123,
+  .fork = 0,
+};
+
+static void
+mkdir_p(const char *path) {
+  char dir[512];
+  strcpy(dir, path);
+
+  for (char *c = dir + 1;; c++) {
+    if (*c != '/' && *c != '\0') continue;
+
+    char end = *c;
+
+    *c = '\0';
+
+    uv_fs_t fs;
+    uv_fs_mkdir(loop, &fs, dir, 0777, NULL);
+    uv_fs_req_cleanup(&fs);
+
+    if (end == '\0') break;
+
+    *c = end;
+  }
+}
+
+static void
+copy_file(const char *name) {
+  int err;
+
+  char source[512], target[512];
+  snprintf(source, sizeof(source), "%s%s", FIXTURE, name);
+  snprintf(target, sizeof(target), "%s%s", PLATFORM, name);
+
+  uv_fs_t fs;
+  uv_fs_unlink(loop, &fs, target, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  err = uv_fs_copyfile(loop, &fs, source, target, 0, NULL);
+  uv_fs_req_cleanup(&fs);
+  assert(err == 0);
+}
+
+static bool
+exists(const char *path) {
+  uv_fs_t fs;
+  int err = uv_fs_stat(loop, &fs, path, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  return err == 0;
+}
+
+int
+main() {
+  int err;
+
+  loop = uv_default_loop();
+
+  mkdir_p(PLATFORM "/lib");
+  mkdir_p(PLATFORM "/bin");
+
+  copy_file("/lib/" APPLING_PLATFORM_ENTRY);
+  copy_file(RUNTIME);
+
+  uv_fs_t fs;
+  uv_fs_unlink(loop, &fs, DIR "/ready", NULL);
+  uv_fs_req_cleanup(&fs);
+
+  appling_link_t link = {
+    .id = ID,
+  };
+
+  appling_link_t other_link = {
+    .id = OTHER_ID,
+  };
+
+  err = appling_ready(&platform, &link);
+  assert(err == 1);
+
+  // The cache holds a single entry for the link against the platform version.
+  FILE *file = fopen(DIR "/ready", "rb");
+  assert(file);
+
+  uint8_t data[256];
+  size_t len = fread(data, 1, sizeof(data), file);
+
+  fclose(file);
+
+  uint8_t expected[1 + 64 + 1 + 32 + 1 + 1];
+  size_t i = 0;
+
+  expected[i++] = 64;
+  memcpy(&expected[i], ID, 64);
+  i += 64;
+  expected[i++] = 0; // Data
+  memset(&expected[i], 0xaa, 32);
+  i += 32;
+  expected[i++] = 123; // Length
+  expected[i++] = 0;   // Fork
+
+  assert(len == sizeof(expected));
+  assert(memcmp(data, expected, len) == 0);
+
+  // Without a runtime, only the cached link is still found ready.
+  uv_fs_unlink(loop, &fs, PLATFORM RUNTIME, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  err = appling_ready(&platform, &link);
+  assert(err == 1);
+
+  err = appling_ready(&platform, &other_link);
+  assert(err != 1);
+
+  // The cache is checked before the platform library is loaded, so the cached
+  // link is found ready even without one.
+  err = uv_fs_rename(loop, &fs, PLATFORM "/lib/" APPLING_PLATFORM_ENTRY, PLATFORM "/lib/moved", NULL);
+  uv_fs_req_cleanup(&fs);
+  assert(err == 0);
+
+  err = appling_ready(&platform, &link);
+  assert(err == 1);
+
+  err = uv_fs_rename(loop, &fs, PLATFORM "/lib/moved", PLATFORM "/lib/" APPLING_PLATFORM_ENTRY, NULL);
+  uv_fs_req_cleanup(&fs);
+  assert(err == 0);
+
+  // A preflight removes the link from the cache whatever its outcome, which
+  // leaves the cache empty.
+  appling_preflight(&platform, &link);
+
+  assert(!exists(DIR "/ready"));
+
+  err = appling_ready(&platform, &link);
+  assert(err != 1);
+
+  return 0;
+}
@@ -0,0 +1,57 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+uv_loop_t *loop;
+
+appling_platform_t platform;
+
+appling_resolve_t req;
+
+appling_run_t run;
+
+bool run_called = false;
+
+static void
+on_run(appling_run_t *req, int status, int64_t exit_status, uint64_t duration) {
+  run_called = true;
+
+  printf("status=%d exit_status=%lld duration=%.1fms\n", status, (long long) exit_status, duration / 1e6);
+
+  assert(status == 0);
+  assert(exit_status == 0);
+}
+
+static void
+on_resolve(appling_resolve_t *req, int status) {
+  int err;
+
+  assert(status == 0);
+
+  appling_link_t link = {
+    .id = "bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb",
+  };
+
+  err = appling_run_preflight(loop, &run, &platform, &link, 10000, on_run);
+  assert(err == 0);
+}
+
+int
+main() {
+  int err;
+
+  loop = uv_default_loop();
+
+  err = appling_resolve(loop, &req, "test/fixtures/platform", &platform, on_resolve);
+  assert(err == 0);
+
+  uv_run(loop, UV_RUN_DEFAULT);
+
+  assert(run_called);
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+
+#define DIR "test/fixtures/run"
+
+#define TIMEOUT 200
+
+uv_loop_t *loop;
+
+appling_platform_t platform = {
+  .path = DIR,
+};
+
+appling_platform_t missing = {
+  .path = DIR "/missing",
+};
+
+appling_link_t ready_link = {
+  .id = "bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb",
+};
+
+appling_run_t runs[2];
+
+int run_called = 0;
+
+static void
+on_missing_run(appling_run_t *req, int status, int64_t exit_status, uint64_t duration) {
+  run_called++;
+
+  printf("status=%d exit_status=%lld\n", status, (long long) exit_status);
+
+  // A runtime that can't be spawned is reported once its handles have closed.
+  assert(status == UV_ENOENT);
+  assert(exit_status == -1);
+}
+
+static void
+on_run(appling_run_t *req, int status, int64_t exit_status, uint64_t duration) {
+  int err;
+
+  run_called++;
+
+  printf("status=%d exit_status=%lld duration=%.1fms\n", status, (long long) exit_status, duration / 1e6);
+
+  assert(status == UV_ETIMEDOUT);
+  // The deadline is kept to the millisecond that the loop time is kept to.
+  assert(duration >= (TIMEOUT - 1) * 1000000ULL);
+  assert(duration < 10000 * 1000000ULL);
+
+  err = appling_run_ready(loop, &runs[1], &missing, &ready_link, TIMEOUT, on_missing_run);
+  assert(err == 0);
+}
+
+int
+main() {
+  int err;
+
+  loop = uv_default_loop();
+
+  // Stand in for the runtime of the platform with one that never exits.
+  appling_path_t runtime;
+  size_t runtime_len = sizeof(appling_path_t);
+
+  err = uv_exepath(runtime, &runtime_len);
+  assert(err == 0);
+
+  *strrchr(runtime, '/') = '\0';
+
+  strcat(runtime, "/fixtures/runtime");
+
+  uv_fs_t fs;
+
+  uv_fs_mkdir(loop, &fs, DIR "/bin", 0777, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  err = uv_fs_copyfile(loop, &fs, runtime, DIR "/bin/pear-runtime", 0, NULL);
+  uv_fs_req_cleanup(&fs);
+  assert(err == 0);
+
+  setenv("APPLING_TEST_RUNTIME", "hang", 1);
+
+  err = appling_run_ready(loop, &runs[0], &platform, &ready_link, TIMEOUT, on_run);
+  assert(err == 0);
+
+  err = uv_run(loop, UV_RUN_DEFAULT);
+  assert(err == 0);
+
+  assert(run_called == 2);
+
+  return 0;
+}
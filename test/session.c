@@ -0,0 +1,180 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+#include "fixtures/app.h"
+
+#define EXE "test/fixtures/app/" APPLING_TARGET "/" APPLING_TEST_EXE
+
+// A platform made of the entry library as built and the fixture runtime, which
+// reports progress as described in fixtures/runtime.c.
+#define DIR      "test/fixtures/session"
+#define PLATFORM DIR "/by-dkey/aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa/0/by-arch/" APPLING_TARGET
+
+uv_loop_t *loop;
+
+appling_platform_t platform;
+
+appling_resolve_t req;
+
+int progress_called = 0;
+
+uint64_t progress_downloaded;
+uint64_t progress_total;
+
+static void
+on_progress(uint64_t downloaded, uint64_t total) {
+  // The first record is split across two writes by the runtime.
+  if (progress_called == 0) assert(downloaded == 0);
+
+  assert(downloaded <= total);
+  assert(progress_called == 0 || downloaded >= progress_downloaded);
+
+  progress_called++;
+
+  progress_downloaded = downloaded;
+  progress_total = total;
+}
+
+#ifndef _WIN32
+static void
+copy_file(const char *dir, const char *name, const char *target) {
+  int err;
+
+  appling_path_t source;
+  size_t source_len = sizeof(appling_path_t);
+
+  err = uv_exepath(source, &source_len);
+  assert(err == 0);
+
+  *strrchr(source, '/') = '\0';
+
+  strcat(source, dir);
+  strcat(source, name);
+
+  uv_fs_t fs;
+  uv_fs_unlink(loop, &fs, target, NULL);
+  uv_fs_req_cleanup(&fs);
+
+  err = uv_fs_copyfile(loop, &fs, source, target, 0, NULL);
+  uv_fs_req_cleanup(&fs);
+  assert(err == 0);
+}
+
+static void
+mkdir_p(const char *path) {
+  char dir[512];
+  strcpy(dir, path);
+
+  for (char *c = dir + 1;; c++) {
+    if (*c != '/' && *c != '\0') continue;
+
+    char end = *c;
+
+    *c = '\0';
+
+    uv_fs_t fs;
+    uv_fs_mkdir(loop, &fs, dir, 0777, NULL);
+    uv_fs_req_cleanup(&fs);
+
+    if (end == '\0') break;
+
+    *c = end;
+  }
+}
+
+static void
+preflight(const appling_link_t *link) {
+  int err;
+
+  mkdir_p(PLATFORM "/lib");
+  mkdir_p(PLATFORM "/bin");
+
+  copy_file("/", APPLING_PLATFORM_ENTRY, PLATFORM "/lib/" APPLING_PLATFORM_ENTRY);
+  copy_file("/fixtures/", "runtime", PLATFORM "/bin/pear-runtime");
+
+  appling_platform_t built = {
+    .path = PLATFORM,
+  };
+
+  setenv("APPLING_TEST_RUNTIME", "progress", 1);
+
+  appling_session_t session;
+  err = appling_session_open(&session, &built);
+  assert(err == 0);
+
+  err = appling_session_preflight(&session, link, on_progress);
+  assert(err == 0);
+
+  appling_session_close(&session);
+
+  unsetenv("APPLING_TEST_RUNTIME");
+
+  printf("progress_called=%d downloaded=%llu total=%llu\n", progress_called, (unsigned long long) progress_downloaded, (unsigned long long) progress_total);
+
+  // The burst of records in between is coalesced, but the first and the last
+  // are always forwarded.
+  assert(progress_called >= 2);
+  assert(progress_called < 100);
+
+  assert(progress_downloaded == 1000);
+  assert(progress_total == 1000);
+}
+#endif
+
+static void
+on_resolve(appling_resolve_t *req, int status) {
+  int err;
+
+  assert(status == 0);
+
+  appling_app_t app = {
+    .path = EXE,
+  };
+
+  appling_link_t link = {
+    .id = "bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb",
+  };
+
+  appling_session_t session;
+  err = appling_session_open(&session, &platform);
+  assert(err == 0);
+
+  err = appling_session_ready(&session, &link);
+  assert(err == 1);
+
+  err = appling_session_launch(&session, &app, &link, "Example");
+  assert(err == 0);
+
+  appling_session_close(&session);
+
+#ifdef _WIN32
+  err = appling_session_open(&session, &platform);
+  assert(err == 0);
+
+  err = appling_session_preflight(&session, &link, on_progress);
+  assert(err == 0);
+
+  appling_session_close(&session);
+#else
+  preflight(&link);
+#endif
+}
+
+int
+main() {
+  int err;
+
+  loop = uv_default_loop();
+
+  err = appling_resolve(loop, &req, "test/fixtures/platform", &platform, on_resolve);
+  assert(err == 0);
+
+  uv_run(loop, UV_RUN_DEFAULT);
+
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+#include "fixtures/testnet.h"
+
+uv_loop_t *loop;
+
+appling_test_testnet_t testnet;
+
+appling_updater_t updater;
+
+bool update_called = false;
+bool close_called = false;
+
+static void
+on_close(appling_updater_t *updater) {
+  close_called = true;
+
+  appling_test_testnet_stop(&testnet);
+}
+
+static void
+on_update(appling_updater_t *updater, int status, uint64_t length, uint64_t fork) {
+  int e;
+
+  update_called = true;
+
+  assert(status == 0);
+
+  printf("length=%llu fork=%llu\n", (unsigned long long) length, (unsigned long long) fork);
+
+  assert(length > 0);
+
+  if (updater->closing) return;
+
+  e = appling_updater_close(updater, on_close);
+  assert(e == 0);
+}
+
+static void
+on_testnet(appling_test_testnet_t *testnet) {
+  int e;
+
+  appling_updater_options_t options = {
+    .version = 0,
+    .nodes = testnet->nodes,
+  };
+
+  e = appling_updater_open(loop, &updater, testnet->keys[0], "test/fixtures/updater/check", &options, on_update);
+  assert(e == 0);
+
+  e = appling_updater_check(&updater);
+  assert(e == 0);
+}
+
+int
+main() {
+  int e;
+
+  loop = uv_default_loop();
+
+  appling_test_testnet_start(loop, &testnet, 1, on_testnet);
+
+  e = uv_run(loop, UV_RUN_DEFAULT);
+  assert(e == 0);
+
+  assert(update_called);
+  assert(close_called);
+
+  assert(testnet.stopped);
+  assert(testnet.connections > 0);
+
+  return 0;
+}
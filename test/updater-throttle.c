@@ -0,0 +1,110 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <uv.h>
+
+#include "../include/appling.h"
+#include "fixtures/testnet.h"
+
+// A quarter of the platform per second, so that downloading it takes at least
+// three seconds once the first second's worth has been spent.
+#define RATE (APPLING_TEST_TESTNET_SIZE / 4)
+
+uv_loop_t *loop;
+
+appling_test_testnet_t testnet;
+
+appling_updater_t updater;
+
+uint64_t started;
+
+int update_called = 0;
+int close_called = 0;
+
+static void
+open_updater(const char *dir, uint64_t download_rate, uint64_t disk_rate);
+
+static void
+on_close(appling_updater_t *updater) {
+  close_called++;
+
+  switch (close_called) {
+  case 1:
+    // Cap the disk writes alone, into a directory of its own so that nothing
+    // has been downloaded yet.
+    open_updater("test/fixtures/updater/disk-rate", 0, RATE);
+    break;
+
+  case 2:
+    appling_test_testnet_stop(&testnet);
+    break;
+  }
+}
+
+static void
+on_update(appling_updater_t *updater, int status, uint64_t length, uint64_t fork) {
+  int e;
+
+  update_called++;
+
+  assert(status == 0);
+
+  uint64_t elapsed = uv_now(loop) - started;
+
+  printf("length=%llu elapsed=%llu\n", (unsigned long long) length, (unsigned long long) elapsed);
+
+  assert(length > 0);
+  assert(elapsed >= 2000);
+
+  if (updater->closing) return;
+
+  e = appling_updater_close(updater, on_close);
+  assert(e == 0);
+}
+
+static void
+open_updater(const char *dir, uint64_t download_rate, uint64_t disk_rate) {
+  int e;
+
+  appling_updater_options_t options = {
+    .version = 0,
+    .download_rate = download_rate,
+    .disk_rate = disk_rate,
+    .nodes = testnet.nodes,
+  };
+
+  uv_update_time(loop);
+
+  started = uv_now(loop);
+
+  e = appling_updater_open(loop, &updater, testnet.keys[0], dir, &options, on_update);
+  assert(e == 0);
+
+  e = appling_updater_check(&updater);
+  assert(e == 0);
+}
+
+static void
+on_testnet(appling_test_testnet_t *testnet) {
+  open_updater("test/fixtures/updater/download-rate", RATE, 0);
+}
+
+int
+main() {
+  int e;
+
+  loop = uv_default_loop();
+
+  appling_test_testnet_start(loop, &testnet, 1, on_testnet);
+
+  e = uv_run(loop, UV_RUN_DEFAULT);
+  assert(e == 0);
+
+  assert(update_called == 2);
+  assert(close_called == 2);
+
+  assert(testnet.stopped);
+  assert(testnet.connections > 0);
+
+  return 0;
+}